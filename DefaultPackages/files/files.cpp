@@ -134,7 +134,7 @@ void filesRealpath(Thread *thread) {
     char *x = realpath(stringToCString(thread->variable(0).object), path);
 
     if (x != nullptr) {
-        thread->returnOEValueFromFunction(Emojicode::stringFromChar(path));
+        thread->returnOEValueFromFunction(Emojicode::stringFromChar(path, thread));
     }
     else {
         thread->returnErrorFromFunction(errnoToError());
@@ -148,13 +148,21 @@ void filesRealpath(Thread *thread) {
 void fileDataPut(Thread *thread) {
     FILE *file = fopen(stringToCString(thread->variable(0).object), "wb");
 
-    if (nothingnessOrErrorEnum(file != nullptr, thread)) {
+    if (file == nullptr) {
+        thread->returnErrorFromFunction(errnoToError());
         return;
     }
 
     auto *d = thread->variable(1).object->val<Data>();
 
+    bool pinned = Emojicode::hasPinnedBytes(d);
+    if (pinned) {
+        Emojicode::allowGC();
+    }
     fwrite(d->bytes, 1, d->length, file);
+    if (pinned) {
+        Emojicode::disallowGCAndPauseIfNeeded();
+    }
 
     nothingnessOrErrorEnum(ferror(file) == 0, thread);
     fclose(file);
@@ -172,8 +180,10 @@ void fileDataGet(Thread *thread) {
     long length = ftell(file);
     state = fseek(file, 0, SEEK_SET);
 
-    auto bytesObject = thread->retain(Emojicode::newArray(length));
+    auto bytesObject = thread->retain(Emojicode::newPinnedArray(length));
+    Emojicode::allowGC();
     fread(bytesObject->val<char>(), 1, length, file);
+    Emojicode::disallowGCAndPauseIfNeeded();
     if (ferror(file) != 0) {
         fclose(file);
         thread->release(1);
@@ -237,7 +247,14 @@ void fileWriteData(Thread *thread) {
     FILE *f = file(thread->thisObject());
     auto *d = thread->variable(0).object->val<Data>();
 
+    bool pinned = Emojicode::hasPinnedBytes(d);
+    if (pinned) {
+        Emojicode::allowGC();
+    }
     fwrite(d->bytes, 1, d->length, f);
+    if (pinned) {
+        Emojicode::disallowGCAndPauseIfNeeded();
+    }
     nothingnessOrErrorEnum(ferror(f) == 0, thread);
 }
 
@@ -245,8 +262,10 @@ void fileReadData(Thread *thread) {
     FILE *f = file(thread->thisObject());
     Emojicode::EmojicodeInteger n = thread->variable(0).raw;
 
-    auto bytesObject = thread->retain(Emojicode::newArray(n));
-    fread(bytesObject->val<char>(), 1, n, f);
+    auto bytesObject = thread->retain(Emojicode::newPinnedArray(n));
+    Emojicode::allowGC();
+    size_t read = fread(bytesObject->val<char>(), 1, n, f);
+    Emojicode::disallowGCAndPauseIfNeeded();
     if (ferror(f) != 0) {
         thread->returnErrorFromFunction(errnoToError());
         thread->release(1);
@@ -255,7 +274,7 @@ void fileReadData(Thread *thread) {
 
     Emojicode::Object *obj = Emojicode::newObject(Emojicode::CL_DATA);
     auto *data = obj->val<Data>();
-    data->length = n;
+    data->length = read;
     data->bytesObject = bytesObject.unretainedPointer();
     data->bytes = bytesObject->val<char>();
 
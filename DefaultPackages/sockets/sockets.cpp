@@ -76,7 +76,9 @@ void serverAccept(Thread *thread) {
     int listenerDescriptor = *thread->thisObject()->val<int>();
     struct sockaddr_storage clientAddress{};
     unsigned int addressSize = sizeof(clientAddress);
+    Emojicode::allowGC();
     int connectionAddress = accept(listenerDescriptor, reinterpret_cast<struct sockaddr *>(&clientAddress), &addressSize);
+    Emojicode::disallowGCAndPauseIfNeeded();
 
     if (connectionAddress == -1) {
         thread->returnNothingnessFromFunction();
@@ -91,7 +93,16 @@ void serverAccept(Thread *thread) {
 void socketSendData(Thread *thread) {
     int connectionAddress = *thread->thisObject()->val<int>();
     auto *data = thread->variable(0).object->val<Data>();
-    thread->returnFromFunction(send(connectionAddress, data->bytes, data->length, 0) == -1);
+    // Pinned bytes are not moved, so other threads can collect garbage while this one waits for the socket.
+    bool pinned = Emojicode::hasPinnedBytes(data);
+    if (pinned) {
+        Emojicode::allowGC();
+    }
+    bool failed = send(connectionAddress, data->bytes, data->length, 0) == -1;
+    if (pinned) {
+        Emojicode::disallowGCAndPauseIfNeeded();
+    }
+    thread->returnFromFunction(failed);
 }
 
 void socketClose(Thread *thread) {
@@ -104,8 +115,10 @@ void socketReadBytes(Thread *thread) {
     int connectionAddress = *thread->thisObject()->val<int>();
     Emojicode::EmojicodeInteger n = thread->variable(0).raw;
 
-    auto bytesObject = thread->retain(Emojicode::newArray(n));
-    size_t read = recv(connectionAddress, bytesObject->val<char>(), n, 0);
+    auto bytesObject = thread->retain(Emojicode::newPinnedArray(n));
+    Emojicode::allowGC();
+    ssize_t read = recv(connectionAddress, bytesObject->val<char>(), n, 0);
+    Emojicode::disallowGCAndPauseIfNeeded();
 
     if (read < 1) {
         thread->release(1);
@@ -0,0 +1,118 @@
+//
+//  BytecodeReader.cpp
+//  emojicodeaot
+//
+//  Created by Theo Weidmann on 26/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#include "BytecodeReader.hpp"
+#include "../EmojicodeInstructions.h"
+
+namespace EmojicodeAOT {
+
+// The layout read here must be kept in sync with Reader.cpp of the Real-Time Engine.
+
+class BytecodeFile {
+public:
+    explicit BytecodeFile(FILE *in) : in_(in) {}
+
+    uint8_t readByte() {
+        int c = fgetc(in_);
+        if (c == EOF) {
+            throw BytecodeError("Unexpected end of bytecode file.");
+        }
+        return static_cast<uint8_t>(c);
+    }
+    uint16_t readUInt16() {
+        uint16_t value = readByte();
+        return value | readByte() << 8;
+    }
+    uint32_t readUInt32() {
+        uint32_t value = readUInt16();
+        return value | static_cast<uint32_t>(readUInt16()) << 16;
+    }
+    void skip(size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            readByte();
+        }
+    }
+
+    void readFunction() {
+        readUInt16();  // vti
+        skip(readUInt16() * 4);  // name
+        readByte();  // argument count
+        skip(readUInt16() * (3 * 2 + 2 * 4));  // object variable records
+        readByte();  // context
+        readUInt16();  // frame size
+
+        FunctionCode function;
+        function.native = readUInt16() != 0;
+        function.instructions.resize(readUInt32());
+        for (auto &instruction : function.instructions) {
+            instruction = readUInt32();
+        }
+        functions_.push_back(std::move(function));
+    }
+
+    void readProtocolTable() {
+        auto protocolCount = readUInt16();
+        if (protocolCount > 0) {
+            readUInt16();  // max index
+            readUInt16();  // offset
+            for (uint16_t i = 0; i < protocolCount; i++) {
+                readUInt16();  // index
+                skip(readUInt16() * 2);
+            }
+        }
+    }
+
+    void readPackage() {
+        auto nameLength = readByte();
+        if (nameLength > 0) {
+            skip(nameLength + 2 * 2);  // name and version
+        }
+
+        for (auto classCount = readUInt16(); classCount > 0; classCount--) {
+            readUInt32();  // name
+            readUInt16();  // superclass
+            readUInt16();  // instance variable count
+            readUInt16();  // method count
+            readByte();  // inherits initializers
+            readUInt16();  // initializer count
+            auto localMethodCount = readUInt16();
+            auto localInitializerCount = readUInt16();
+            for (auto i = 0; i < localMethodCount + localInitializerCount; i++) {
+                readFunction();
+            }
+            readProtocolTable();
+            skip(readUInt16() * 3 * 2);  // instance variable records
+        }
+
+        for (auto functionCount = readUInt16(); functionCount > 0; functionCount--) {
+            readFunction();
+        }
+    }
+
+    std::vector<FunctionCode> read() {
+        auto version = readByte();
+        if (version != kByteCodeVersion) {
+            throw BytecodeError("The bytecode file is not compatible with this version of emojicodeaot.");
+        }
+        readUInt16();  // class count
+        readUInt16();  // function count
+        for (auto packageCount = readByte(); packageCount > 0; packageCount--) {
+            readPackage();
+        }
+        return std::move(functions_);
+    }
+private:
+    FILE *in_;
+    std::vector<FunctionCode> functions_;
+};
+
+std::vector<FunctionCode> readFunctions(FILE *in) {
+    return BytecodeFile(in).read();
+}
+
+}  // namespace EmojicodeAOT
@@ -0,0 +1,38 @@
+//
+//  BytecodeReader.hpp
+//  emojicodeaot
+//
+//  Created by Theo Weidmann on 26/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#ifndef BytecodeReader_hpp
+#define BytecodeReader_hpp
+
+#include "../EmojicodeShared.h"
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+namespace EmojicodeAOT {
+
+/// The bytecode of a function as found in the bytecode file.
+struct FunctionCode {
+    std::vector<EmojicodeInstruction> instructions;
+    /// Whether the function is implemented by a native function of a package
+    bool native = false;
+};
+
+/// Thrown if the bytecode file is malformed or incompatible.
+class BytecodeError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// Reads all functions from the bytecode file @c in in the order in which the Real-Time Engine reads them. The
+/// Real-Time Engine identifies compiled functions by this order.
+std::vector<FunctionCode> readFunctions(FILE *in);
+
+}  // namespace EmojicodeAOT
+
+#endif /* BytecodeReader_hpp */
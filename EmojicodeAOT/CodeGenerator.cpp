@@ -0,0 +1,335 @@
+//
+//  CodeGenerator.cpp
+//  emojicodeaot
+//
+//  Created by Theo Weidmann on 26/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#include "CodeGenerator.hpp"
+#include "../EmojicodeInstructions.h"
+#include <cinttypes>
+#include <cstdarg>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace EmojicodeAOT {
+
+const char *kPrologue = R"(// Generated by emojicodeaot. Do not edit.
+//
+// Compile into a shared object next to the bytecode file, e.g.
+// c++ -std=c++14 -O2 -shared -fPIC -I<Emojicode>/EmojicodeReal-TimeEngine program.emojib.cpp -o program.emojib.so
+
+#include "JIT.hpp"
+#include "Memory.hpp"
+#include <cmath>
+#include <cstring>
+
+using namespace Emojicode;
+
+#define EXIT(offset) do { *operandStackPointer = sp; return cells + (offset); } while (0)
+// Leaves the code at a backward jump if the garbage collector waits for threads to pause. The interpreter pauses
+// when it executes the jump.
+#define POLL(offset) do { if (pauseThreads) EXIT(offset); } while (0)
+
+static bool matches(Function *function, unsigned int count, uint64_t hash) {
+    if (function->block.instructionCount != count || function->handler != nullptr) {
+        return false;
+    }
+    uint64_t h = UINT64_C(14695981039346656037);
+    for (unsigned int i = 0; i < count; i++) {
+        h = (h ^ function->block.instructions[i]) * UINT64_C(1099511628211);
+    }
+    return h == hash;
+}
+)";
+
+uint64_t hashInstructions(const std::vector<EmojicodeInstruction> &instructions) {
+    uint64_t h = UINT64_C(14695981039346656037);
+    for (auto instruction : instructions) {
+        h = (h ^ instruction) * UINT64_C(1099511628211);
+    }
+    return h;
+}
+
+std::string format(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+std::string format(const char *format, ...) {
+    char buffer[256];
+    va_list list;
+    va_start(list, format);
+    vsnprintf(buffer, sizeof(buffer), format, list);
+    va_end(list);
+    return buffer;
+}
+
+/// Generates the code for one function.
+class FunctionGenerator {
+public:
+    FunctionGenerator(const std::vector<EmojicodeInstruction> &instructions, size_t index)
+        : instructions_(instructions), index_(index), compiled_(instructions.size() + 1, false),
+          targets_(instructions.size() + 1, false), code_(instructions.size() + 1) {}
+
+    /// Generates the code and returns whether any instruction was compiled.
+    bool generate();
+    void write(std::ostream &out) const;
+private:
+    const std::vector<EmojicodeInstruction> &instructions_;
+    size_t index_;
+    std::vector<bool> compiled_;
+    std::vector<bool> targets_;
+    std::vector<std::string> code_;
+
+    std::string jump(unsigned int target) {
+        targets_[target] = true;
+        return format("goto i%u;", target);
+    }
+
+    /// Returns the code of the instruction at @c offset or an empty string if it is not supported.
+    std::string instructionCode(unsigned int offset, unsigned int next);
+};
+
+/// Returns the code that pushes the integer with the bit pattern @c bits.
+std::string integerLiteral(uint64_t bits) {
+    return format("(sp++)->raw = static_cast<EmojicodeInteger>(UINT64_C(%" PRIu64 "));", bits);
+}
+
+std::string binaryOperation(const char *field, const char *op) {
+    return format("sp--; sp[-1] = Value(sp[-1].%s %s sp[0].%s);", field, op, field);
+}
+
+std::string FunctionGenerator::instructionCode(unsigned int offset, unsigned int next) {
+    const EmojicodeInstruction *w = instructions_.data() + offset + 1;
+    switch (static_cast<Instructions>(instructions_[offset])) {
+        case INS_PUSH_SINGLE_STACK:
+            return format("*sp++ = v[%u];", w[0]);
+        case INS_COPY_TO_STACK:
+            return format("v[%u] = *--sp;", w[0]);
+        case INS_PUSH_WITH_SIZE_STACK:
+            return format("std::memcpy(sp, v + %u, %u * sizeof(Value)); sp += %u;", w[0], w[1], w[1]);
+        case INS_COPY_TO_STACK_SIZE:
+            return format("sp -= %u; std::memcpy(v + %u, sp, %u * sizeof(Value));", w[0], w[1], w[0]);
+        case INS_PUSH_VT_REFERENCE_STACK:
+            return format("(sp++)->value = v + %u;", w[0]);
+        case INS_PUSH_STACK_REFERENCE_N_BACK:
+            return format("sp->value = sp - %u; sp++;", w[0]);
+        case INS_PUSH_VALUE_FROM_REFERENCE:
+            return format("sp--; std::memmove(sp, sp->value, %u * sizeof(Value)); sp += %u;", w[0], w[0]);
+        case INS_THIS:
+            return "*sp++ = v[-1];";
+        case INS_PUSH_N:
+            return format("sp += %u;", w[0]);
+        case INS_POP:
+            return "sp--;";
+        case INS_GET_32_INTEGER:
+            return format("(sp++)->raw = INT64_C(%" PRId64 ");", static_cast<int64_t>(w[0]) - INT32_MAX);
+        case INS_GET_64_INTEGER:
+            return integerLiteral(static_cast<uint64_t>(w[0]) << 32 | w[1]);
+        case INS_GET_DOUBLE: {
+            int64_t scale = (static_cast<int64_t>(w[0]) << 32) ^ w[1];
+            double value = ldexp(static_cast<double>(scale)/INT64_MAX, static_cast<int>(w[2]));
+            // Hexadecimal floating point literals are not available in C++14, hence the bits are stored
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return integerLiteral(bits) + format("  // %.17g", value);
+        }
+        case INS_GET_TRUE:
+            return "(sp++)->raw = 1;";
+        case INS_GET_FALSE:
+            return "(sp++)->raw = 0;";
+        case INS_GET_NOTHINGNESS:
+            return "(sp++)->raw = T_NOTHINGNESS;";
+        case INS_GET_SYMBOL:
+            return format("(sp++)->character = %u;", w[0]);
+        case INS_GET_CLASS_FROM_INDEX:
+            return format("(sp++)->klass = cells[%u].klass;", offset + 1);
+        case INS_GET_STRING_POOL:
+            return format("(sp++)->object = stringPool[%u];", w[0]);
+        case INS_ADD_INTEGER:
+            return binaryOperation("raw", "+");
+        case INS_SUBTRACT_INTEGER:
+            return binaryOperation("raw", "-");
+        case INS_MULTIPLY_INTEGER:
+            return binaryOperation("raw", "*");
+        case INS_DIVIDE_INTEGER:
+            return binaryOperation("raw", "/");
+        case INS_REMAINDER_INTEGER:
+            return binaryOperation("raw", "%");
+        case INS_BINARY_AND_INTEGER:
+            return binaryOperation("raw", "&");
+        case INS_BINARY_OR_INTEGER:
+            return binaryOperation("raw", "|");
+        case INS_BINARY_XOR_INTEGER:
+            return binaryOperation("raw", "^");
+        case INS_SHIFT_LEFT_INTEGER:
+            return binaryOperation("raw", "<<");
+        case INS_SHIFT_RIGHT_INTEGER:
+            return binaryOperation("raw", ">>");
+        case INS_BINARY_NOT_INTEGER:
+            return "sp[-1].raw = ~sp[-1].raw;";
+        case INS_GREATER_INTEGER:
+            return binaryOperation("raw", ">");
+        case INS_GREATER_OR_EQUAL_INTEGER:
+            return binaryOperation("raw", ">=");
+        case INS_EQUAL_PRIMITIVE:
+            return binaryOperation("raw", "==");
+        case INS_SAME_OBJECT:
+            return binaryOperation("object", "==");
+        case INS_EQUAL_SYMBOL:
+            return binaryOperation("character", "==");
+        case INS_INVERT_BOOLEAN:
+            return "sp[-1] = Value(!sp[-1].raw);";
+        case INS_ADD_DOUBLE:
+            return binaryOperation("doubl", "+");
+        case INS_SUBTRACT_DOUBLE:
+            return binaryOperation("doubl", "-");
+        case INS_MULTIPLY_DOUBLE:
+            return binaryOperation("doubl", "*");
+        case INS_DIVIDE_DOUBLE:
+            return binaryOperation("doubl", "/");
+        case INS_GREATER_DOUBLE:
+            return binaryOperation("doubl", ">");
+        case INS_GREATER_OR_EQUAL_DOUBLE:
+            return binaryOperation("doubl", ">=");
+        case INS_EQUAL_DOUBLE:
+            return binaryOperation("doubl", "==");
+        case INS_REMAINDER_DOUBLE:
+            return "sp--; sp[-1] = Value(std::fmod(sp[-1].doubl, sp[0].doubl));";
+        case INS_INT_TO_DOUBLE:
+            return "sp[-1] = Value(static_cast<double>(sp[-1].raw));";
+        case INS_IS_NOTHINGNESS:
+            return "sp[-1] = Value(sp[-1].value->raw == T_NOTHINGNESS);";
+        case INS_IS_ERROR:
+            return "sp[-1] = Value(sp[-1].value->raw == T_ERROR);";
+        case INS_JUMP_FORWARD:
+            return jump(next + w[0]);
+        case INS_JUMP_FORWARD_IF:
+            return "if ((--sp)->raw) " + jump(next + w[0]);
+        case INS_JUMP_FORWARD_IF_NOT:
+            return "if (!(--sp)->raw) " + jump(next + w[0]);
+        case INS_JUMP_BACKWARD_IF:
+            return format("POLL(%u); ", offset) + "if ((--sp)->raw) " + jump(next - w[0]);
+        case INS_JUMP_BACKWARD_IF_NOT:
+            return format("POLL(%u); ", offset) + "if (!(--sp)->raw) " + jump(next - w[0]);
+        case INS_INCREMENT:
+            return format("v[%u].raw++;", w[0]);
+        case INS_DECREMENT:
+            return format("v[%u].raw--;", w[0]);
+        case INS_ADD_INTEGER_IMMEDIATE_TO_STACK:
+            return format("v[%u].raw += INT64_C(%" PRId64 ");", w[0], static_cast<int64_t>(w[1]) - INT32_MAX);
+#define STACK_IMMEDIATE_JUMP_CODE(name, op) \
+        case INS_JUMP_BACKWARD_IF_STACK_##name##_IMMEDIATE: \
+            return format("POLL(%u); if (v[%u].raw " #op " INT64_C(%" PRId64 ")) ", offset, w[0], \
+                          static_cast<int64_t>(w[1]) - INT32_MAX) + jump(next - w[2]); \
+        case INS_JUMP_FORWARD_IF_NOT_STACK_##name##_IMMEDIATE: \
+            return format("if (!(v[%u].raw " #op " INT64_C(%" PRId64 "))) ", w[0], \
+                          static_cast<int64_t>(w[1]) - INT32_MAX) + jump(next + w[2]);
+        STACK_IMMEDIATE_COMPARISONS(STACK_IMMEDIATE_JUMP_CODE)
+#undef STACK_IMMEDIATE_JUMP_CODE
+        default:
+            return "";
+    }
+}
+
+bool FunctionGenerator::generate() {
+    bool anyCompiled = false;
+    auto count = static_cast<unsigned int>(instructions_.size());
+    for (unsigned int offset = 0; offset < count;) {
+        auto instruction = static_cast<Instructions>(instructions_[offset]);
+        auto operands = instruction == INS_CLOSURE ? closureOperandCount(instructions_.data() + offset)
+                                                   : operandCount(instruction);
+        if (operands < 0 || offset + operands >= count) {
+            throw BytecodeError(format("Function %zu contains an illegal instruction.", index_));
+        }
+        auto next = offset + 1 + operands;
+        bool simpleJump = instruction >= INS_JUMP_FORWARD && instruction <= INS_JUMP_BACKWARD_IF_NOT;
+        bool stackImmediateJump = instruction >= INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE &&
+                                  instruction <= INS_JUMP_FORWARD_IF_NOT_STACK_EQUAL_IMMEDIATE;
+        if (simpleJump || stackImmediateJump) {
+            bool backward = instruction == INS_JUMP_BACKWARD_IF || instruction == INS_JUMP_BACKWARD_IF_NOT ||
+                            (stackImmediateJump && instruction <= INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE);
+            auto distance = instructions_[next - 1];
+            if (backward ? distance > next : next + distance > count) {
+                throw BytecodeError(format("Function %zu contains a jump that leaves the function body.", index_));
+            }
+        }
+        code_[offset] = instructionCode(offset, next);
+        if (!code_[offset].empty()) {
+            compiled_[offset] = true;
+            anyCompiled = true;
+        }
+        else {
+            code_[offset] = format("EXIT(%u);", offset);
+        }
+        offset = next;
+    }
+    code_[count] = format("EXIT(%u);", count);
+    return anyCompiled;
+}
+
+void FunctionGenerator::write(std::ostream &out) const {
+    auto count = instructions_.size();
+    out << "\nstatic Function *function" << index_ << ";\n";
+    out << "static CompiledFunction compiled" << index_ << ";\n\n";
+    out << "static InstructionCell* run" << index_
+        << "(Value *v, Value **operandStackPointer, const void *entry) {\n";
+    out << "    static const void *entries[] = {";
+    for (size_t offset = 0; offset < count; offset++) {
+        out << (offset % 8 == 0 ? "\n        " : " ");
+        out << (compiled_[offset] ? format("&&i%zu,", offset) : "nullptr,");
+    }
+    out << "\n    };\n";
+    out << "    if (entry == nullptr) {\n";
+    out << "        compiled" << index_ << ".entries = entries;\n";
+    out << "        return nullptr;\n";
+    out << "    }\n";
+    out << "    InstructionCell *cells = function" << index_ << "->block.cells;\n";
+    out << "    Value *sp = *operandStackPointer;\n";
+    out << "    goto *entry;\n";
+    for (size_t offset = 0; offset <= count; offset++) {
+        if (code_[offset].empty()) {
+            continue;
+        }
+        if (compiled_[offset] || targets_[offset]) {
+            out << "i" << offset << ":\n";
+        }
+        out << "    " << code_[offset] << "\n";
+    }
+    out << "}\n";
+}
+
+void generateCode(const std::vector<FunctionCode> &functions, std::ostream &out) {
+    out << kPrologue;
+
+    std::vector<size_t> generated;
+    for (size_t i = 0; i < functions.size(); i++) {
+        if (functions[i].native) {
+            continue;
+        }
+        FunctionGenerator generator(functions[i].instructions, i);
+        if (generator.generate()) {
+            generator.write(out);
+            generated.push_back(i);
+        }
+    }
+
+    out << "\nextern \"C\" void emojicodeInstallCompiledFunctions(Function *const *functions, size_t count) {\n";
+    out << "    if (count != " << functions.size() << ") {\n";
+    out << "        return;\n";
+    out << "    }\n";
+    for (auto i : generated) {
+        out << format("    if (matches(functions[%zu], %zu, UINT64_C(0x%" PRIx64 "))) {\n", i,
+                      functions[i].instructions.size(), hashInstructions(functions[i].instructions));
+        out << "        function" << i << " = functions[" << i << "];\n";
+        out << "        compiled" << i << ".run = run" << i << ";\n";
+        out << "        run" << i << "(nullptr, nullptr, nullptr);\n";
+        out << "        functions[" << i << "]->compiled = &compiled" << i << ";\n";
+        out << "    }\n";
+    }
+    out << "}\n";
+}
+
+}  // namespace EmojicodeAOT
@@ -0,0 +1,28 @@
+//
+//  CodeGenerator.hpp
+//  emojicodeaot
+//
+//  Created by Theo Weidmann on 26/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#ifndef CodeGenerator_hpp
+#define CodeGenerator_hpp
+
+#include "BytecodeReader.hpp"
+#include <ostream>
+
+namespace EmojicodeAOT {
+
+/// Writes C++ source code to @c out that, compiled into a shared object, provides machine code for @c functions to
+/// the Real-Time Engine.
+///
+/// Like the machine code generated by the JIT, the code runs the stack, constant, arithmetic, comparison and jump
+/// instructions of a function directly and returns to the interpreter at any other instruction. It is installed by
+/// the exported function @c emojicodeInstallCompiledFunctions, which skips functions whose bytecode differs from the
+/// bytecode the code was generated from.
+void generateCode(const std::vector<FunctionCode> &functions, std::ostream &out);
+
+}  // namespace EmojicodeAOT
+
+#endif /* CodeGenerator_hpp */
@@ -0,0 +1,64 @@
+//
+//  main.cpp
+//  emojicodeaot
+//
+//  Created by Theo Weidmann on 26/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#include "BytecodeReader.hpp"
+#include "CodeGenerator.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace EmojicodeAOT;
+
+int main(int argc, char *argv[]) {
+    std::string outPath;
+
+    signed char ch;
+    while ((ch = getopt(argc, argv, "o:")) != -1) {
+        switch (ch) {
+            case 'o':
+                outPath = optarg;
+                break;
+            default:
+                break;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        fprintf(stderr, "🚨 No bytecode file provided. Usage: emojicodeaot [-o out.cpp] file.emojib\n");
+        return 1;
+    }
+
+    FILE *in = fopen(argv[0], "rb");
+    if (in == nullptr) {
+        fprintf(stderr, "🚨 File couldn't be opened.\n");
+        return 1;
+    }
+
+    if (outPath.empty()) {
+        outPath = std::string(argv[0]) + ".cpp";
+    }
+
+    try {
+        auto functions = readFunctions(in);
+        fclose(in);
+        std::ofstream out(outPath);
+        generateCode(functions, out);
+        if (!out) {
+            fprintf(stderr, "🚨 Couldn't write %s.\n", outPath.c_str());
+            return 1;
+        }
+    }
+    catch (BytecodeError &e) {
+        fprintf(stderr, "🚨 %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -22,6 +22,16 @@ public:
     Type analyse(SemanticAnalyser *analyser, const TypeExpectation &expectation) override;
     void generateExpr(FnCodeGenerator *fncg) const override;
     void toCode(Prettyprinter &pretty) const override;
+
+    /// Writes an instruction of the INS_JUMP_*_STACK_*_IMMEDIATE family starting with @c less instead of the operator
+    /// and a jump on its result if this operator compares a local integer variable with an integer literal.
+    /// The number of instructions to jump must be written by the caller.
+    /// @returns False if the operator does not have this shape. Nothing has been written in that case.
+    bool generateComparisonJump(FnCodeGenerator *fncg, EmojicodeInstruction less) const;
+    /// Writes an instruction that adds to the local integer variable @c varId in place if this operator adds an integer
+    /// literal to or subtracts one from that variable.
+    /// @returns False if the operator does not have this shape. Nothing has been written in that case.
+    bool generateInPlaceAddition(FnCodeGenerator *fncg, VariableID varId) const;
 private:
     struct BuiltIn {
         explicit BuiltIn(Type type) : returnType(std::move(type)), swap(false) {}
@@ -9,6 +9,8 @@
 #include "ASTBinaryOperator.hpp"
 #include "../Generation/CallCodeGenerator.hpp"
 #include "../Generation/FnCodeGenerator.hpp"
+#include "ASTLiterals.hpp"
+#include <cstdlib>
 
 namespace EmojicodeCompiler {
 
@@ -20,7 +22,97 @@ void ASTBinaryOperator::generateExpr(FnCodeGenerator *fncg) const {
         return;
     }
 
-    CallCodeGenerator(fncg, instruction_).generate(*left_, calleeType_, args_, operatorName(operator_));
+    CallCodeGenerator(fncg, instruction_, tailPosition_).generate(*left_, calleeType_, args_, operatorName(operator_));
+}
+
+/// Returns @c expr as variable if it reads a local integer variable, on which the fused instructions operate.
+const ASTGetVariable* localIntegerVariable(const std::shared_ptr<ASTExpr> &expr) {
+    auto variable = dynamic_cast<const ASTGetVariable *>(expr.get());
+    if (variable == nullptr || variable->reference() || variable->inInstanceScope()) {
+        return nullptr;
+    }
+    const Type &type = variable->expressionType();
+    if (type.type() != TypeType::ValueType || type.optional() || type.valueType() != VT_INTEGER) {
+        return nullptr;
+    }
+    return variable;
+}
+
+/// Returns @c expr as literal if it is an integer literal that can be encoded as immediate operand.
+const ASTNumberLiteral* integerImmediate(const std::shared_ptr<ASTExpr> &expr) {
+    auto literal = dynamic_cast<const ASTNumberLiteral *>(expr.get());
+    if (literal == nullptr || !literal->isInteger() || std::llabs(literal->integerValue()) > INT32_MAX) {
+        return nullptr;
+    }
+    return literal;
+}
+
+void writeImmediate(FnCodeGenerator *fncg, int64_t value) {
+    fncg->wr().writeInstruction(static_cast<EmojicodeInstruction>(value + INT32_MAX));
+}
+
+bool ASTBinaryOperator::generateComparisonJump(FnCodeGenerator *fncg, EmojicodeInstruction less) const {
+    if (!builtIn_) {
+        return false;
+    }
+    auto variable = localIntegerVariable(left_);
+    auto literal = integerImmediate(right_);
+    bool variableLeft = variable != nullptr && literal != nullptr;
+    if (!variableLeft) {
+        variable = localIntegerVariable(right_);
+        literal = integerImmediate(left_);
+        if (variable == nullptr || literal == nullptr) {
+            return false;
+        }
+    }
+
+    // Offsets of the comparisons from less, see STACK_IMMEDIATE_COMPARISONS
+    EmojicodeInstruction comparison;
+    switch (instruction_) {
+        case INS_GREATER_INTEGER:
+            comparison = variableLeft ? 2 : 0;
+            break;
+        case INS_GREATER_OR_EQUAL_INTEGER:
+            comparison = variableLeft ? 3 : 1;
+            break;
+        case INS_EQUAL_PRIMITIVE:
+            comparison = 4;
+            break;
+        default:
+            return false;
+    }
+
+    fncg->wr().writeInstruction(less + comparison);
+    fncg->wr().writeInstruction(fncg->scoper().getVariable(variable->varId()).stackIndex.value());
+    writeImmediate(fncg, literal->integerValue());
+    return true;
+}
+
+bool ASTBinaryOperator::generateInPlaceAddition(FnCodeGenerator *fncg, VariableID varId) const {
+    if (!builtIn_ || (instruction_ != INS_ADD_INTEGER && instruction_ != INS_SUBTRACT_INTEGER)) {
+        return false;
+    }
+    auto variable = localIntegerVariable(left_);
+    auto literal = integerImmediate(right_);
+    if ((variable == nullptr || literal == nullptr) && instruction_ == INS_ADD_INTEGER) {
+        variable = localIntegerVariable(right_);
+        literal = integerImmediate(left_);
+    }
+    if (variable == nullptr || literal == nullptr || variable->varId() != varId) {
+        return false;
+    }
+
+    auto value = instruction_ == INS_SUBTRACT_INTEGER ? -literal->integerValue() : literal->integerValue();
+    auto index = fncg->scoper().getVariable(varId).stackIndex.value();
+    if (value == 1 || value == -1) {
+        fncg->wr().writeInstruction(value == 1 ? INS_INCREMENT : INS_DECREMENT);
+        fncg->wr().writeInstruction(index);
+        return true;
+    }
+    fncg->wr().writeInstruction(INS_ADD_INTEGER_IMMEDIATE_TO_STACK);
+    fncg->wr().writeInstruction(index);
+    writeImmediate(fncg, value);
+    return true;
 }
 
 
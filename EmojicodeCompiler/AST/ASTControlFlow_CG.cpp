@@ -7,6 +7,7 @@
 //
 
 #include "ASTControlFlow.hpp"
+#include "ASTBinaryOperator.hpp"
 #include "../Generation/CallCodeGenerator.hpp"
 #include "../Generation/FnCodeGenerator.hpp"
 #include "ASTProxyExpr.hpp"
@@ -28,12 +29,17 @@ void ASTIf::generate(FnCodeGenerator *fncg) const {
         }
 
         fncg->scoper().pushScope();
-        conditions_[i]->generate(fncg);
-        fncg->wr().writeInstruction(INS_JUMP_FORWARD_IF_NOT);
+        auto binaryOperator = dynamic_cast<ASTBinaryOperator *>(conditions_[i].get());
+        if (binaryOperator == nullptr ||
+            !binaryOperator->generateComparisonJump(fncg, INS_JUMP_FORWARD_IF_NOT_STACK_LESS_IMMEDIATE)) {
+            conditions_[i]->generate(fncg);
+            fncg->wr().writeInstruction(INS_JUMP_FORWARD_IF_NOT);
+        }
         placeholder = fncg->wr().writeInstructionsCountPlaceholderCoin();
         fncg->scoper().pushScope();
         blocks_[i].generate(fncg);
-        fncg->scoper().popScope(0);
+        fncg->scoper().popScope(fncg->wr().count());
+        fncg->scoper().popScope(fncg->wr().count());
     }
 
     if (hasElse()) {
@@ -42,7 +48,7 @@ void ASTIf::generate(FnCodeGenerator *fncg) const {
         placeholder->write();
         fncg->scoper().pushScope();
         blocks_.back().generate(fncg);
-        fncg->scoper().popScope(0);
+        fncg->scoper().popScope(fncg->wr().count());
         elseCountPlaceholder.write();
     }
     else {
@@ -62,9 +68,12 @@ void ASTRepeatWhile::generate(FnCodeGenerator *fncg) const {
     auto delta = fncg->wr().count();
     block_.generate(fncg);
     placeholder.write();
-    condition_->generate(fncg);
-
-    fncg->wr().writeInstruction(INS_JUMP_BACKWARD_IF);
+    auto binaryOperator = dynamic_cast<ASTBinaryOperator *>(condition_.get());
+    if (binaryOperator == nullptr ||
+        !binaryOperator->generateComparisonJump(fncg, INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE)) {
+        condition_->generate(fncg);
+        fncg->wr().writeInstruction(INS_JUMP_BACKWARD_IF);
+    }
     fncg->wr().writeInstruction(fncg->wr().count() - delta + 1);
     fncg->scoper().popScope(fncg->wr().count());
 }
@@ -74,6 +83,7 @@ void ASTErrorHandler::generate(FnCodeGenerator *fncg) const {
     fncg->scoper().pushScope();
     auto &var = fncg->scoper().declareVariable(varId_, value_->expressionType());
     fncg->copyToVariable(var.stackIndex, false, value_->expressionType());
+    var.initialize(fncg->wr().count());
     fncg->pushVariableReference(var.stackIndex, false);
     fncg->wr().writeInstruction(INS_IS_ERROR);
     fncg->wr().writeInstruction(INS_JUMP_FORWARD_IF);
@@ -106,6 +116,7 @@ void ASTForIn::generate(FnCodeGenerator *fncg) const {
     auto &elementVar = fncg->scoper().declareVariable(elementVar_, elementType_);
 
     fncg->copyToVariable(itVar.stackIndex, false, Type(PR_ENUMERATEABLE, false));
+    itVar.initialize(fncg->wr().count());
 
     fncg->wr().writeInstruction(INS_JUMP_FORWARD);
     auto placeholder = fncg->wr().writeInstructionsCountPlaceholderCoin();
@@ -117,6 +128,7 @@ void ASTForIn::generate(FnCodeGenerator *fncg) const {
     auto delta = fncg->wr().count();
     callCG.generate(getVar, itVar.type, ASTArguments(position()), std::u32string(1, 0x1F53D));
     fncg->copyToVariable(elementVar.stackIndex, false, Type(PR_ENUMERATEABLE, false));
+    elementVar.initialize(fncg->wr().count());
     block_.generate(fncg);
     placeholder.write();
 
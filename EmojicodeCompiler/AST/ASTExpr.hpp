@@ -29,6 +29,9 @@ public:
     const Type& expressionType() const { return expressionType_; }
     void setExpressionType(const Type &type) { expressionType_ = type; }
     void setTemporarilyScoped() { temporarilyScoped_ = true; }
+    /// Called if the value of this expression is returned from the function right away. Expressions that are calls
+    /// can then be generated as tail calls.
+    virtual void setTailPosition() {}
 
     void generate(FnCodeGenerator *fncg) const;
     virtual Type analyse(SemanticAnalyser *analyser, const TypeExpectation &expectation) = 0;
@@ -48,7 +51,7 @@ public:
     void toCode(Prettyprinter &pretty) const override;
 
     void setReference() { reference_ = true; }
-    bool reference() { return reference_; }
+    bool reference() const { return reference_; }
     const std::u32string& name() { return name_; }
 private:
     bool reference_ = false;
@@ -153,8 +156,10 @@ public:
     Type analyse(SemanticAnalyser *analyser, const TypeExpectation &expectation) override;
     void generateExpr(FnCodeGenerator *fncg) const override;
     void toCode(Prettyprinter &pretty) const override;
+    void setTailPosition() override { tailPosition_ = true; }
 private:
     bool valueType_ = false;
+    bool tailPosition_ = false;
     std::u32string name_;
     const std::shared_ptr<ASTTypeExpr> callee_;
     ASTArguments args_;
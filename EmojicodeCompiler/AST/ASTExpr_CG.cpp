@@ -65,6 +65,7 @@ void ASTConditionalAssignment::generateExpr(FnCodeGenerator *fncg) const {
     expr_->generate(fncg);
     auto &var = fncg->scoper().declareVariable(varId_, expr_->expressionType());
     fncg->copyToVariable(var.stackIndex, false, expr_->expressionType());
+    var.initialize(fncg->wr().count());
     fncg->pushVariableReference(var.stackIndex, false);
     fncg->wr().writeInstruction({ INS_IS_NOTHINGNESS, INS_INVERT_BOOLEAN });
     var.stackIndex.increment();
@@ -73,7 +74,7 @@ void ASTConditionalAssignment::generateExpr(FnCodeGenerator *fncg) const {
 
 void ASTTypeMethod::generateExpr(FnCodeGenerator *fncg) const {
     auto ins = valueType_ ? INS_CALL_FUNCTION : INS_DISPATCH_TYPE_METHOD;
-    TypeMethodCallCodeGenerator(fncg, ins).generate(*callee_, callee_->expressionType(), args_, name_);
+    TypeMethodCallCodeGenerator(fncg, ins, tailPosition_).generate(*callee_, callee_->expressionType(), args_, name_);
 }
 
 void ASTSuperMethod::generateExpr(FnCodeGenerator *fncg) const {
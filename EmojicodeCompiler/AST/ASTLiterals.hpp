@@ -53,6 +53,9 @@ public:
     Type analyse(SemanticAnalyser *analyser, const TypeExpectation &expectation) override;
     void generateExpr(FnCodeGenerator *fncg) const override;
     void toCode(Prettyprinter &pretty) const override;
+
+    bool isInteger() const { return type_ == NumberType::Integer; }
+    int64_t integerValue() const { return integerValue_; }
 private:
     enum class NumberType {
         Double, Integer
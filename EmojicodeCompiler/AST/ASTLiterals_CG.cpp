@@ -64,6 +64,7 @@ void ASTDictionaryLiteral::generateExpr(FnCodeGenerator *fncg) const {
     InitializationCallCodeGenerator(fncg, INS_NEW_OBJECT).generate(type, type_, ASTArguments(position()),
                                                                    std::u32string(1, 0x1F438));
     fncg->copyToVariable(var.stackIndex, false, type_);
+    var.initialize(fncg->wr().count());
 
     auto getVar = ASTProxyExpr(position(), type_, [&var](auto *fncg) {
         fncg->pushVariable(var.stackIndex, false, var.type);
@@ -86,6 +87,7 @@ void ASTListLiteral::generateExpr(FnCodeGenerator *fncg) const {
     InitializationCallCodeGenerator(fncg, INS_NEW_OBJECT).generate(type, type_, ASTArguments(position()),
                                                                    std::u32string(1, 0x1F438));
     fncg->copyToVariable(var.stackIndex, false, type_);
+    var.initialize(fncg->wr().count());
 
     auto getVar = ASTProxyExpr(position(), type_, [&var](auto *fncg) {
         fncg->pushVariable(var.stackIndex, false, var.type);
@@ -107,6 +109,7 @@ void ASTConcatenateLiteral::generateExpr(FnCodeGenerator *fncg) const {
     InitializationCallCodeGenerator(fncg, INS_NEW_OBJECT).generate(type, type_, ASTArguments(position()),
                                                                    std::u32string(1, 0x1F195));
     fncg->copyToVariable(var.stackIndex, false, type_);
+    var.initialize(fncg->wr().count());
 
     auto getVar = ASTProxyExpr(position(), type_, [&var](auto *fncg) {
         fncg->pushVariable(var.stackIndex, false, var.type);
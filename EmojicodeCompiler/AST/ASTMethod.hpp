@@ -18,6 +18,8 @@ namespace EmojicodeCompiler {
 class SemanticAnalyser;
 
 class ASTMethodable : public ASTExpr {
+public:
+    void setTailPosition() override { tailPosition_ = true; }
 protected:
     explicit ASTMethodable(const SourcePosition &p) : ASTExpr(p), args_(p) {}
     ASTMethodable(const SourcePosition &p, ASTArguments args) : ASTExpr(p), args_(std::move(args)) {}
@@ -26,6 +28,7 @@ protected:
     EmojicodeInstruction instruction_;
     ASTArguments args_;
     bool builtIn_ = false;
+    bool tailPosition_ = false;
     Type calleeType_ = Type::noReturn();
 private:
     std::pair<bool, Type> builtIn(const Type &type, const std::u32string &name);
@@ -17,7 +17,7 @@ void ASTMethod::generateExpr(FnCodeGenerator *fncg) const {
         fncg->wr().writeInstruction(instruction_);
         return;
     }
-    CallCodeGenerator(fncg, instruction_).generate(*callee_, calleeType_,  args_, name_);
+    CallCodeGenerator(fncg, instruction_, tailPosition_).generate(*callee_, calleeType_,  args_, name_);
 }
 
 }  // namespace EmojicodeCompiler
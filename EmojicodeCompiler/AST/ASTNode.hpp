@@ -32,9 +32,10 @@ private:
 };
 
 class ASTVariable {
-protected:
+public:
     bool inInstanceScope() const { return inInstanceScope_; }
-    VariableID varId() { return varId_; }
+    VariableID varId() const { return varId_; }
+protected:
     void copyVariableAstInfo(const ResolvedVariable &, SemanticAnalyser *analyser);
 protected:
     bool inInstanceScope_ = false;
@@ -37,6 +37,7 @@ void ASTReturn::analyse(SemanticAnalyser *analyser) {
     }
 
     analyser->expectType(analyser->function()->returnType, &value_);
+    value_->setTailPosition();
 }
 
 void ASTRaise::analyse(SemanticAnalyser *analyser) {
@@ -7,6 +7,7 @@
 //
 
 #include "ASTVariables.hpp"
+#include "ASTBinaryOperator.hpp"
 #include "../Generation/FnCodeGenerator.hpp"
 
 namespace EmojicodeCompiler {
@@ -37,6 +38,14 @@ CGScoper::Variable& ASTVariableAssignmentDecl::generateGetVariable(FnCodeGenerat
 }
 
 void ASTVariableAssignmentDecl::generateAssignment(FnCodeGenerator *fncg) const {
+    if (!declare_ && !inInstanceScope()) {
+        auto binaryOperator = dynamic_cast<ASTBinaryOperator *>(expr_.get());
+        if (binaryOperator != nullptr && binaryOperator->generateInPlaceAddition(fncg, varId())) {
+            fncg->scoper().getVariable(varId()).initialize(fncg->wr().count());
+            return;
+        }
+    }
+
     expr_->generate(fncg);
 
     auto &var = generateGetVariable(fncg);
@@ -7,6 +7,7 @@
 //
 
 #include "CallCodeGenerator.hpp"
+#include "../Package/Package.hpp"
 
 namespace EmojicodeCompiler {
 
@@ -19,4 +20,48 @@ EmojicodeInstruction CallCodeGenerator::generateArguments(const ASTArguments &ar
     return static_cast<EmojicodeInstruction>(argumentsSize);
 }
 
+EmojicodeInstruction CallCodeGenerator::callInstruction(Function *function) const {
+    auto instruction = intrinsicInstruction(function);
+    if (instruction == instruction_ && tailCall_) {
+        return tailCallInstruction();
+    }
+    return instruction;
+}
+
+EmojicodeInstruction CallCodeGenerator::tailCallInstruction() const {
+    switch (instruction_) {
+        case INS_DISPATCH_METHOD: return INS_TAIL_CALL_DISPATCH_METHOD;
+        case INS_DISPATCH_TYPE_METHOD: return INS_TAIL_CALL_DISPATCH_TYPE_METHOD;
+        case INS_DISPATCH_PROTOCOL: return INS_TAIL_CALL_DISPATCH_PROTOCOL;
+        case INS_CALL_CONTEXTED_FUNCTION: return INS_TAIL_CALL_CONTEXTED_FUNCTION;
+        case INS_CALL_FUNCTION: return INS_TAIL_CALL_FUNCTION;
+        default: return instruction_;
+    }
+}
+
+EmojicodeInstruction CallCodeGenerator::intrinsicInstruction(Function *function) const {
+    if (!function->isNative() || function->package()->name() != "s") {
+        return instruction_;
+    }
+    // The linking table indices of the natives in the s package, see sLinkingTable in standard.cpp
+    if (instruction_ == INS_DISPATCH_METHOD) {
+        switch (function->linkingTabelIndex()) {
+            case 45: return INS_INTRINSIC_LIST_APPEND;
+            case 46: return INS_INTRINSIC_LIST_GET;
+            case 49: return INS_INTRINSIC_LIST_COUNT;
+            case 55: return INS_INTRINSIC_LIST_SET;
+            case 61: return INS_INTRINSIC_STRING_LENGTH;
+            case 63: return INS_INTRINSIC_STRING_SYMBOL_AT;
+        }
+    }
+    else if (instruction_ == INS_CALL_CONTEXTED_FUNCTION) {
+        switch (function->linkingTabelIndex()) {
+            case 18: return INS_INTRINSIC_INTEGER_ABSOLUTE;
+            case 26: return INS_INTRINSIC_DOUBLE_SQRT;
+            case 28: return INS_INTRINSIC_DOUBLE_FLOOR;
+        }
+    }
+    return instruction_;
+}
+
 }  // namespace EmojicodeCompiler
@@ -19,8 +19,9 @@ namespace EmojicodeCompiler {
 
 class CallCodeGenerator {
 public:
-    explicit CallCodeGenerator(FnCodeGenerator *fncg, EmojicodeInstruction instruction)
-    : fncg_(fncg), instruction_(instruction) {}
+    /// @param tailCall Whether the value of the call is returned right away, which allows generating a tail call.
+    explicit CallCodeGenerator(FnCodeGenerator *fncg, EmojicodeInstruction instruction, bool tailCall = false)
+    : fncg_(fncg), instruction_(instruction), tailCall_(tailCall) {}
     void generate(const ASTExpr &callee, const Type &calleeType, const ASTArguments &args, const std::u32string &name) {
         auto argSize = generateArguments(args);
         callee.generate(fncg_);
@@ -32,19 +33,28 @@ protected:
     }
 
     virtual void writeInstructions(EmojicodeInstruction argSize, const Type &type, const std::u32string &name) {
-        fncg_->wr().writeInstruction(instruction_);
+        auto function = lookupFunction(type, name);
+        fncg_->wr().writeInstruction(callInstruction(function));
         if (instruction_ == INS_DISPATCH_PROTOCOL) {
             fncg()->wr().writeInstruction(type.protocol()->index);
         }
-        fncg_->wr().writeInstruction(lookupFunction(type, name)->vtiForUse());
+        fncg_->wr().writeInstruction(function->vtiForUse());
         fncg_->wr().writeInstruction(argSize);
     }
 
+    /// Returns the instruction with which @c function is called. This is the intrinsic instruction the interpreter
+    /// provides for @c function, the tail call variant of the instruction of this generator or that instruction itself.
+    EmojicodeInstruction callInstruction(Function *function) const;
+
     FnCodeGenerator* fncg() { return fncg_; }
     EmojicodeInstruction generateArguments(const ASTArguments &args);
 private:
     FnCodeGenerator *fncg_;
     EmojicodeInstruction instruction_;
+    bool tailCall_;
+
+    EmojicodeInstruction intrinsicInstruction(Function *function) const;
+    EmojicodeInstruction tailCallInstruction() const;
 };
 
 class TypeMethodCallCodeGenerator : public CallCodeGenerator {
@@ -116,9 +116,7 @@ void writeClass(const Type &classType, Writer *writer) {
     writeProtocolTable(eclass, writer);
 
     std::vector<ObjectVariableInformation> information;
-    for (auto variable : eclass->instanceScope().map()) {
-        // TODO:    variable.second.type().objectVariableRecords(variable.second.id(), &information);
-    }
+    eclass->cgScoper().instanceObjectVariableRecords(0, &information);
 
     writer->writeUInt16(information.size());
 
@@ -219,7 +217,14 @@ void generateCode(Writer *writer, Application *app) {
     tableSizePlaceholder.write(vtWithProtocolsCount > 0 ? biggestBoxIdentifier - smallestBoxIdentifier + 1 : 0);
     smallestPlaceholder.write(smallestBoxIdentifier);
 
-    auto binfo = app->boxObjectVariableInformation();
+    auto &binfo = app->boxObjectVariableInformation();
+    for (auto &package : app->packagesInOrder()) {
+        for (auto vt : package->valueTypes()) {
+            for (auto idPair : vt->genericIds()) {
+                vt->cgScoper().instanceObjectVariableRecords(0, &binfo[idPair.second]);
+            }
+        }
+    }
     writer->writeInstruction(binfo.size());
     for (auto information : binfo) {
         writer->writeUInt16(information.size());
@@ -15,19 +15,23 @@
 namespace EmojicodeCompiler {
 
 void FnCodeGenerator::generate() {
+    scoper_.pushScope();
+
     if (fn_->isNative()) {
+        // Natives were not analysed. The arguments are declared nonetheless so that the garbage collector knows about
+        // them while the native runs.
+        scoper_.resizeVariables(fn_->arguments.size());
+        declareArguments();
         wr().writeInstruction({ INS_TRANSFER_CONTROL_TO_NATIVE, INS_RETURN });
-        return;
     }
-
-    scoper_.pushScope();
-
-    declareArguments();
-
-    fn_->ast()->generate(this);
+    else {
+        declareArguments();
+        fn_->ast()->generate(this);
+    }
 
     fn_->setFullSize(scoper_.size());
     scoper_.popScope(wr().count());
+    fn_->objectVariableInformation() = scoper_.objectVariableInformation();
 }
 
 void FnCodeGenerator::declareArguments() {
@@ -11,6 +11,7 @@
 #include "../CompilerError.hpp"
 #include "../Functions/Function.hpp"
 #include "../Functions/FunctionType.hpp"
+#include "../Types/TypeDefinition.hpp"
 #include "FunctionWriter.hpp"
 #include <fstream>
 #include <iostream>
@@ -44,8 +45,43 @@ void Writer::writeBytes(const char *bytes, size_t count) {
     data_.append(bytes, count);
 }
 
+/// Returns the name under which the Real-Time Engine reports @c function, e.g. 🐟.🎺 for a method, 🐟.🐇🐬 for a type
+/// method and 🐟.🆕🆒 for an initializer. Closures are called 🍇.
+std::u32string reportedName(Function *function) {
+    std::u32string name;
+    switch (function->owningType().type()) {
+        case TypeType::Class:
+        case TypeType::ValueType:
+        case TypeType::Enum:
+        case TypeType::Protocol:
+            name = function->owningType().typeDefinition()->name() + U".";
+            break;
+        default:
+            break;
+    }
+    switch (function->functionType()) {
+        case FunctionType::ClassMethod:
+            name.push_back(E_RABBIT);
+            break;
+        case FunctionType::ObjectInitializer:
+        case FunctionType::ValueTypeInitializer:
+            if (function->name() != std::u32string(1, E_NEW_SIGN)) {
+                name.push_back(E_NEW_SIGN);
+            }
+            break;
+        default:
+            break;
+    }
+    return name + function->name();
+}
+
 void Writer::writeFunction(Function *function) {
     writeUInt16(function->getVti());
+    auto name = reportedName(function);
+    writeUInt16(name.size());
+    for (auto c : name) {
+        writeEmojicodeChar(c);
+    }
     writeByte(static_cast<uint8_t>(function->arguments.size()));
 
     writeUInt16(function->objectVariableInformation().size());
@@ -21,7 +21,7 @@ class CGScoper {
 public:
     struct StackIndex {
         friend CGScoper;
-        unsigned int value() { return stackIndex_; }
+        unsigned int value() const { return stackIndex_; }
         void increment() { stackIndex_ += 1; }
     private:
         explicit StackIndex(unsigned int index) : stackIndex_(index) {}
@@ -31,13 +31,25 @@ public:
     struct Variable {
         Type type = Type::noReturn();
         StackIndex stackIndex = StackIndex(0);
-        unsigned int initialized = 0;
+        /// The number of scopes that were on the scope stack when the variable was declared or 0 if the variable is
+        /// not declared at the moment.
+        size_t scopeDepth = 0;
+        bool initialized = false;
         InstructionCount initPosition;
-
+        /// The type and index as of the initialization, which are used to create the garbage collector records.
+        /// Some nodes change them afterwards to access a part of the stored value.
+        Type initType = Type::noReturn();
+        StackIndex initStackIndex = StackIndex(0);
+
+        /// Marks the variable as initialized. @c count must be the number of instructions written after the value
+        /// was stored into the variable. The first call determines from which instruction on the variable is
+        /// considered to hold a value by the garbage collector.
         void initialize(InstructionCount count) {
-            if (initialized == 0) {
-                initialized = 1;
+            if (!initialized) {
+                initialized = true;
                 initPosition = count + 1; // TODO: ???
+                initType = type;
+                initStackIndex = stackIndex;
             }
         }
     };
@@ -50,20 +62,21 @@ public:
 
     void pushScope() {
         scopes_.emplace_back(scopes_.empty() ? 0 : scopes_.back().maxIndex);
-        for (auto &var : variables_) {
-            if (var.initialized > 0) {
-                var.initialized++;
-            }
-        }
     }
+    /// Pops the current scope. A record is created for every variable declared in the scope that was initialized
+    /// and might contain an object reference. @c count must be the number of instructions written so far.
     void popScope(InstructionCount count) {
         auto &scope = scopes_.back();
         reduceOffsetBy(scope.size);
-        for (auto it = variables_.begin() ; it < variables_.begin(); it++) {
-            if (it->initialized == 1) {
-                it->type.objectVariableRecords(it->stackIndex.value(), &fovInfo_, it->initPosition, count);
+        for (auto &var : variables_) {
+            if (var.scopeDepth == scopes_.size()) {
+                if (var.initialized) {
+                    var.initType.objectVariableRecords(var.initStackIndex.value(), &fovInfo_, var.initPosition,
+                                                       count);
+                }
+                var.scopeDepth = 0;
+                var.initialized = false;
             }
-            it->initialized--;
         }
         scopes_.pop_back();
     }
@@ -78,11 +91,27 @@ public:
         scope.size += typeSize;
         var.type = declarationType;
         var.stackIndex = StackIndex(reserveVariable(typeSize));
+        var.scopeDepth = scopes_.size();
+        var.initialized = false;
         return var;
     }
 
-    unsigned int size() const { return size_; };
+    unsigned int size() const { return size_; }
     unsigned int nextIndex() const { return nextIndex_; }
+
+    /// The records created for the variables of all scopes popped so far.
+    const std::vector<FunctionObjectVariableInformation>& objectVariableInformation() const { return fovInfo_; }
+
+    /// Appends the records for all variables declared in this scoper, which must be an instance scoper, to
+    /// @c information. The index of each variable is offset by @c index. @see Type::objectVariableRecords
+    template <typename T, typename... Us>
+    void instanceObjectVariableRecords(int index, std::vector<T> *information, Us... args) const {
+        for (auto &var : variables_) {
+            if (var.scopeDepth > 0) {
+                var.type.objectVariableRecords(index + var.stackIndex.value(), information, args...);
+            }
+        }
+    }
 private:
     struct Scope {
         explicit Scope (size_t minIndex) : minIndex(minIndex), maxIndex(minIndex) {}
@@ -28,6 +28,8 @@ class VariableID {
     friend CapturingSemanticScoper;
 public:
     VariableID() = default;
+    bool operator==(const VariableID &other) const { return id_ == other.id_; }
+    bool operator!=(const VariableID &other) const { return id_ != other.id_; }
 private:
     explicit VariableID(unsigned int id) : id_(id) {}
     unsigned int id_ = 4294967295;
@@ -480,10 +480,7 @@ void Type::objectVariableRecords(int index, std::vector<T> *information, Us... a
 
             auto optional = storageType() == StorageType::SimpleOptional;
             auto size = information->size();
-            for (auto variable : valueType()->instanceScope().map()) {
-                // TODO:               auto vindex = index + variable.second.id() + (optional ? 1 : 0);
-                // variable.second.type().objectVariableRecords(vindex, information, args...);
-            }
+            valueType()->cgScoper().instanceObjectVariableRecords(index + (optional ? 1 : 0), information, args...);
             if (optional) {
                 auto info = T(static_cast<unsigned int>(information->size() - size), index,
                               ObjectVariableType::ConditionalSkip, args...);
@@ -59,7 +59,7 @@ enum class TypeType {
 };
 
 struct ObjectVariableInformation {
-    ObjectVariableInformation(int index, ObjectVariableType type) : index(index), type(type) {}
+    ObjectVariableInformation(int index, ObjectVariableType type) : index(index), conditionIndex(0), type(type) {}
     ObjectVariableInformation(int index, int condition, ObjectVariableType type)
         : index(index), conditionIndex(condition), type(type) {}
     int index;
@@ -45,12 +45,8 @@ public:
         }
         auto id = package()->app()->boxObjectVariableInformation().size();
         genericIds_.emplace(genericArguments, id);
+        // The records are added once the layout of the value type is known, see generateCode().
         package()->app()->boxObjectVariableInformation().emplace_back();
-
-//        for (auto variable : instanceScope().map()) {
-//            variable.second.type().objectVariableRecords(variable.second.id(), &boxObjectVariableInformation_.back());
-//        }
-        // TODO: fix
         return static_cast<uint32_t>(id);
     }
     
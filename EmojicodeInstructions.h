@@ -9,8 +9,10 @@
 #ifndef EmojicodeInstructions_h
 #define EmojicodeInstructions_h
 
+#include "EmojicodeShared.h"
+
 /// A number identifying the set of byte code instructions and layout in use
-const int kByteCodeVersion = 6;
+const int kByteCodeVersion = 9;
 
 enum Instructions {
     INS_DISPATCH_METHOD = 0x1,
@@ -52,8 +54,11 @@ enum Instructions {
     INS_POP = 0x97,
     INS_PUSH_STACK_REFERENCE_N_BACK = 0x96,
 
+    // Operands: variable
     INS_INCREMENT = 0x2D,
     INS_DECREMENT = 0x2E,
+    // Operands: variable, integer encoded like the operand of INS_GET_32_INTEGER
+    INS_ADD_INTEGER_IMMEDIATE_TO_STACK = 0x2F,
 
     INS_SIMPLE_OPTIONAL_PRODUCE = 0x30,
     INS_PUSH_ERROR = 0x25,
@@ -117,6 +122,20 @@ enum Instructions {
     INS_ERROR_CHECK_BOX_OPTIONAL = 0x74,
     INS_IS_ERROR = 0x75,
 
+    // Compare the integer in a variable with an immediate and jump if the comparison holds or, for the _IF_NOT
+    // variants, does not hold. Operands: variable, integer encoded like the operand of INS_GET_32_INTEGER, number of
+    // instructions to jump, which is counted from the end of the instruction like for the other jump instructions.
+    INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE = 0x76,
+    INS_JUMP_BACKWARD_IF_STACK_LESS_OR_EQUAL_IMMEDIATE = 0x77,
+    INS_JUMP_BACKWARD_IF_STACK_GREATER_IMMEDIATE = 0x78,
+    INS_JUMP_BACKWARD_IF_STACK_GREATER_OR_EQUAL_IMMEDIATE = 0x79,
+    INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE = 0x7A,
+    INS_JUMP_FORWARD_IF_NOT_STACK_LESS_IMMEDIATE = 0x7B,
+    INS_JUMP_FORWARD_IF_NOT_STACK_LESS_OR_EQUAL_IMMEDIATE = 0x7C,
+    INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_IMMEDIATE = 0x7D,
+    INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_OR_EQUAL_IMMEDIATE = 0x7E,
+    INS_JUMP_FORWARD_IF_NOT_STACK_EQUAL_IMMEDIATE = 0x7F,
+
     // Know it’s an object instance and want to cast it to a subclass
     INS_DOWNCAST_TO_CLASS = 0x80,
     INS_CAST_TO_PROTOCOL = 0x81,
@@ -129,8 +148,184 @@ enum Instructions {
     INS_CAPTURE_TYPE_METHOD = 0x93,
     INS_CAPTURE_CONTEXTED_FUNCTION = 0x94,
     INS_CLOSURE_BOX = 0x95,
+
+    // Calls to methods of the s package the compiler replaced with an instruction the interpreter implements inline.
+    // They take the same operands as the INS_DISPATCH_METHOD or INS_CALL_CONTEXTED_FUNCTION they replace and fall back
+    // to the call if the receiver is not an instance of the class itself or the fast path does not apply.
+    INS_INTRINSIC_LIST_COUNT = 0xA0,
+    INS_INTRINSIC_LIST_GET = 0xA1,
+    INS_INTRINSIC_LIST_SET = 0xA2,
+    INS_INTRINSIC_LIST_APPEND = 0xA3,
+    INS_INTRINSIC_STRING_LENGTH = 0xA4,
+    INS_INTRINSIC_STRING_SYMBOL_AT = 0xA5,
+    INS_INTRINSIC_INTEGER_ABSOLUTE = 0xA6,
+    INS_INTRINSIC_DOUBLE_SQRT = 0xA7,
+    INS_INTRINSIC_DOUBLE_FLOOR = 0xA8,
+
+    // Calls whose value is returned right away. They take the same operands as the call instructions they are named
+    // after and replace the stack frame of the calling function with the one of the called function if possible.
+    // They are always followed by INS_RETURN, which is executed if the stack frame could not be replaced.
+    INS_TAIL_CALL_DISPATCH_METHOD = 0xB8,
+    INS_TAIL_CALL_DISPATCH_TYPE_METHOD = 0xB9,
+    INS_TAIL_CALL_DISPATCH_PROTOCOL = 0xBA,
+    INS_TAIL_CALL_CONTEXTED_FUNCTION = 0xBB,
+    INS_TAIL_CALL_FUNCTION = 0xBC,
 };
 
+/// The comparisons for which INS_JUMP_BACKWARD_IF_STACK_*_IMMEDIATE and INS_JUMP_FORWARD_IF_NOT_STACK_*_IMMEDIATE
+/// instructions exist, in the order of the instructions, together with the C++ operator implementing them.
+#define STACK_IMMEDIATE_COMPARISONS(X) \
+    X(LESS, <) \
+    X(LESS_OR_EQUAL, <=) \
+    X(GREATER, >) \
+    X(GREATER_OR_EQUAL, >=) \
+    X(EQUAL, ==)
+
+/// Returns the number of operands following @c instruction or -1 if @c instruction is not a valid instruction.
+/// @c INS_CLOSURE is of variable length and not handled here.
+inline int operandCount(Instructions instruction) {
+    switch (instruction) {
+        case INS_SIMPLE_OPTIONAL_PRODUCE:
+        case INS_PUSH_ERROR:
+        case INS_POP:
+        case INS_GET_CLASS_FROM_INSTANCE:
+        case INS_GET_TRUE:
+        case INS_GET_FALSE:
+        case INS_GET_NOTHINGNESS:
+        case INS_EQUAL_PRIMITIVE:
+        case INS_EQUAL_SYMBOL:
+        case INS_SUBTRACT_INTEGER:
+        case INS_ADD_INTEGER:
+        case INS_MULTIPLY_INTEGER:
+        case INS_DIVIDE_INTEGER:
+        case INS_REMAINDER_INTEGER:
+        case INS_INVERT_BOOLEAN:
+        case INS_OR_BOOLEAN:
+        case INS_AND_BOOLEAN:
+        case INS_GREATER_INTEGER:
+        case INS_GREATER_OR_EQUAL_INTEGER:
+        case INS_SAME_OBJECT:
+        case INS_IS_NOTHINGNESS:
+        case INS_IS_ERROR:
+        case INS_EQUAL_DOUBLE:
+        case INS_SUBTRACT_DOUBLE:
+        case INS_ADD_DOUBLE:
+        case INS_MULTIPLY_DOUBLE:
+        case INS_DIVIDE_DOUBLE:
+        case INS_GREATER_DOUBLE:
+        case INS_GREATER_OR_EQUAL_DOUBLE:
+        case INS_REMAINDER_DOUBLE:
+        case INS_BINARY_AND_INTEGER:
+        case INS_BINARY_OR_INTEGER:
+        case INS_BINARY_XOR_INTEGER:
+        case INS_BINARY_NOT_INTEGER:
+        case INS_SHIFT_LEFT_INTEGER:
+        case INS_SHIFT_RIGHT_INTEGER:
+        case INS_INT_TO_DOUBLE:
+        case INS_UNWRAP_BOX_OPTIONAL:
+        case INS_ERROR_CHECK_BOX_OPTIONAL:
+        case INS_THIS:
+        case INS_DOWNCAST_TO_CLASS:
+        case INS_CAST_TO_CLASS:
+        case INS_RETURN:
+        case INS_TRANSFER_CONTROL_TO_NATIVE:
+            return 0;
+        case INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE:
+        case INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE_REMOTE:
+        case INS_PUSH_N:
+        case INS_BOX_PRODUCE:
+        case INS_UNBOX:
+        case INS_UNBOX_REMOTE:
+        case INS_PUSH_VT_REFERENCE_STACK:
+        case INS_PUSH_VT_REFERENCE_OBJECT:
+        case INS_PUSH_VT_REFERENCE_VT:
+        case INS_PUSH_STACK_REFERENCE_N_BACK:
+        case INS_GET_CLASS_FROM_INDEX:
+        case INS_GET_STRING_POOL:
+        case INS_GET_32_INTEGER:
+        case INS_GET_SYMBOL:
+        case INS_COPY_TO_STACK:
+        case INS_COPY_TO_INSTANCE_VARIABLE:
+        case INS_COPY_VT_VARIABLE:
+        case INS_PUSH_SINGLE_STACK:
+        case INS_PUSH_SINGLE_OBJECT:
+        case INS_PUSH_SINGLE_VT:
+        case INS_PUSH_VALUE_FROM_REFERENCE:
+        case INS_UNWRAP_SIMPLE_OPTIONAL:
+        case INS_ERROR_CHECK_SIMPLE_OPTIONAL:
+        case INS_CAST_TO_PROTOCOL:
+        case INS_CAST_TO_VALUE_TYPE:
+        case INS_JUMP_FORWARD:
+        case INS_JUMP_FORWARD_IF:
+        case INS_JUMP_BACKWARD_IF:
+        case INS_JUMP_FORWARD_IF_NOT:
+        case INS_JUMP_BACKWARD_IF_NOT:
+        case INS_EXECUTE_CALLABLE:
+        case INS_CLOSURE_BOX:
+        case INS_CAPTURE_METHOD:
+        case INS_CAPTURE_TYPE_METHOD:
+        case INS_CAPTURE_CONTEXTED_FUNCTION:
+        case INS_INCREMENT:
+        case INS_DECREMENT:
+            return 1;
+        case INS_DISPATCH_METHOD:
+        case INS_DISPATCH_TYPE_METHOD:
+        case INS_DISPATCH_SUPER:
+        case INS_CALL_CONTEXTED_FUNCTION:
+        case INS_CALL_FUNCTION:
+        case INS_SUPER_INITIALIZER:
+        case INS_NEW_OBJECT:
+        case INS_GET_64_INTEGER:
+        case INS_COPY_TO_STACK_SIZE:
+        case INS_COPY_TO_INSTANCE_VARIABLE_SIZE:
+        case INS_COPY_VT_VARIABLE_SIZE:
+        case INS_PUSH_WITH_SIZE_STACK:
+        case INS_PUSH_WITH_SIZE_OBJECT:
+        case INS_PUSH_WITH_SIZE_VT:
+        case INS_SIMPLE_OPTIONAL_TO_BOX:
+        case INS_SIMPLE_OPTIONAL_TO_BOX_REMOTE:
+        case INS_BOX_PRODUCE_REMOTE:
+        case INS_INTRINSIC_LIST_COUNT:
+        case INS_INTRINSIC_LIST_GET:
+        case INS_INTRINSIC_LIST_SET:
+        case INS_INTRINSIC_LIST_APPEND:
+        case INS_INTRINSIC_STRING_LENGTH:
+        case INS_INTRINSIC_STRING_SYMBOL_AT:
+        case INS_INTRINSIC_INTEGER_ABSOLUTE:
+        case INS_INTRINSIC_DOUBLE_SQRT:
+        case INS_INTRINSIC_DOUBLE_FLOOR:
+        case INS_TAIL_CALL_DISPATCH_METHOD:
+        case INS_TAIL_CALL_DISPATCH_TYPE_METHOD:
+        case INS_TAIL_CALL_CONTEXTED_FUNCTION:
+        case INS_TAIL_CALL_FUNCTION:
+        case INS_ADD_INTEGER_IMMEDIATE_TO_STACK:
+            return 2;
+        case INS_DISPATCH_PROTOCOL:
+        case INS_TAIL_CALL_DISPATCH_PROTOCOL:
+        case INS_GET_DOUBLE:
+        case INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE:
+        case INS_JUMP_BACKWARD_IF_STACK_LESS_OR_EQUAL_IMMEDIATE:
+        case INS_JUMP_BACKWARD_IF_STACK_GREATER_IMMEDIATE:
+        case INS_JUMP_BACKWARD_IF_STACK_GREATER_OR_EQUAL_IMMEDIATE:
+        case INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE:
+        case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_IMMEDIATE:
+        case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_OR_EQUAL_IMMEDIATE:
+        case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_IMMEDIATE:
+        case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_OR_EQUAL_IMMEDIATE:
+        case INS_JUMP_FORWARD_IF_NOT_STACK_EQUAL_IMMEDIATE:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+/// Returns the number of operands of the @c INS_CLOSURE instruction at @c instructions.
+inline unsigned int closureOperandCount(const EmojicodeInstruction *instructions) {
+    auto count = instructions[2];
+    auto recordCount = instructions[5 + 2 * count];
+    return 4 + 2 * count + 1 + 2 * recordCount + 1;
+}
+
 #ifdef DEBUG
 
 #include <cstdio>
@@ -169,6 +364,7 @@ inline void pinsname(Instructions i) {switch(i) {
     case INS_PUSH_ERROR: printf("INS_PUSH_ERROR"); return;
     case INS_INCREMENT: printf("INS_INCREMENT"); return;
     case INS_DECREMENT: printf("INS_DECREMENT"); return;
+    case INS_ADD_INTEGER_IMMEDIATE_TO_STACK: printf("INS_ADD_INTEGER_IMMEDIATE_TO_STACK"); return;
     case INS_SIMPLE_OPTIONAL_PRODUCE: printf("INS_SIMPLE_OPTIONAL_PRODUCE"); return;
     case INS_BOX_PRODUCE: printf("INS_BOX_PRODUCE"); return;
     case INS_UNBOX: printf("INS_UNBOX"); return;
@@ -237,6 +433,30 @@ inline void pinsname(Instructions i) {switch(i) {
     case INS_CLOSURE_BOX: printf("INS_CLOSURE_BOX"); return;
     case INS_PUSH_STACK_REFERENCE_N_BACK: printf("INS_PUSH_STACK_REFERENCE_N_BACK"); return;
     case INS_POP: printf("INS_POP"); return;
+    case INS_INTRINSIC_LIST_COUNT: printf("INS_INTRINSIC_LIST_COUNT"); return;
+    case INS_INTRINSIC_LIST_GET: printf("INS_INTRINSIC_LIST_GET"); return;
+    case INS_INTRINSIC_LIST_SET: printf("INS_INTRINSIC_LIST_SET"); return;
+    case INS_INTRINSIC_LIST_APPEND: printf("INS_INTRINSIC_LIST_APPEND"); return;
+    case INS_INTRINSIC_STRING_LENGTH: printf("INS_INTRINSIC_STRING_LENGTH"); return;
+    case INS_INTRINSIC_STRING_SYMBOL_AT: printf("INS_INTRINSIC_STRING_SYMBOL_AT"); return;
+    case INS_INTRINSIC_INTEGER_ABSOLUTE: printf("INS_INTRINSIC_INTEGER_ABSOLUTE"); return;
+    case INS_INTRINSIC_DOUBLE_SQRT: printf("INS_INTRINSIC_DOUBLE_SQRT"); return;
+    case INS_INTRINSIC_DOUBLE_FLOOR: printf("INS_INTRINSIC_DOUBLE_FLOOR"); return;
+    case INS_TAIL_CALL_DISPATCH_METHOD: printf("INS_TAIL_CALL_DISPATCH_METHOD"); return;
+    case INS_TAIL_CALL_DISPATCH_TYPE_METHOD: printf("INS_TAIL_CALL_DISPATCH_TYPE_METHOD"); return;
+    case INS_TAIL_CALL_DISPATCH_PROTOCOL: printf("INS_TAIL_CALL_DISPATCH_PROTOCOL"); return;
+    case INS_TAIL_CALL_CONTEXTED_FUNCTION: printf("INS_TAIL_CALL_CONTEXTED_FUNCTION"); return;
+    case INS_TAIL_CALL_FUNCTION: printf("INS_TAIL_CALL_FUNCTION"); return;
+    case INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE: printf("INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE"); return;
+    case INS_JUMP_BACKWARD_IF_STACK_LESS_OR_EQUAL_IMMEDIATE: printf("INS_JUMP_BACKWARD_IF_STACK_LESS_OR_EQUAL_IMMEDIATE"); return;
+    case INS_JUMP_BACKWARD_IF_STACK_GREATER_IMMEDIATE: printf("INS_JUMP_BACKWARD_IF_STACK_GREATER_IMMEDIATE"); return;
+    case INS_JUMP_BACKWARD_IF_STACK_GREATER_OR_EQUAL_IMMEDIATE: printf("INS_JUMP_BACKWARD_IF_STACK_GREATER_OR_EQUAL_IMMEDIATE"); return;
+    case INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE: printf("INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE"); return;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_IMMEDIATE: printf("INS_JUMP_FORWARD_IF_NOT_STACK_LESS_IMMEDIATE"); return;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_OR_EQUAL_IMMEDIATE: printf("INS_JUMP_FORWARD_IF_NOT_STACK_LESS_OR_EQUAL_IMMEDIATE"); return;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_IMMEDIATE: printf("INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_IMMEDIATE"); return;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_OR_EQUAL_IMMEDIATE: printf("INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_OR_EQUAL_IMMEDIATE"); return;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_EQUAL_IMMEDIATE: printf("INS_JUMP_FORWARD_IF_NOT_STACK_EQUAL_IMMEDIATE"); return;
 }}
 
 inline int inscount(Instructions i) {switch(i) {
@@ -271,8 +491,9 @@ inline int inscount(Instructions i) {switch(i) {
     case INS_PUSH_WITH_SIZE_VT: return 2;
     case INS_PUSH_VALUE_FROM_REFERENCE: return 1;
     case INS_PUSH_ERROR: return 0;
-    case INS_INCREMENT: return 0;
-    case INS_DECREMENT: return 0;
+    case INS_INCREMENT: return 1;
+    case INS_DECREMENT: return 1;
+    case INS_ADD_INTEGER_IMMEDIATE_TO_STACK: return 2;
     case INS_SIMPLE_OPTIONAL_PRODUCE: return 0;
     case INS_BOX_PRODUCE: return 1;
     case INS_UNBOX: return 1;
@@ -341,6 +562,30 @@ inline int inscount(Instructions i) {switch(i) {
     case INS_CLOSURE_BOX:return 0;
     case INS_PUSH_STACK_REFERENCE_N_BACK: return 1;
     case INS_POP: return 0;
+    case INS_INTRINSIC_LIST_COUNT: return 2;
+    case INS_INTRINSIC_LIST_GET: return 2;
+    case INS_INTRINSIC_LIST_SET: return 2;
+    case INS_INTRINSIC_LIST_APPEND: return 2;
+    case INS_INTRINSIC_STRING_LENGTH: return 2;
+    case INS_INTRINSIC_STRING_SYMBOL_AT: return 2;
+    case INS_INTRINSIC_INTEGER_ABSOLUTE: return 2;
+    case INS_INTRINSIC_DOUBLE_SQRT: return 2;
+    case INS_INTRINSIC_DOUBLE_FLOOR: return 2;
+    case INS_TAIL_CALL_DISPATCH_METHOD: return 2;
+    case INS_TAIL_CALL_DISPATCH_TYPE_METHOD: return 2;
+    case INS_TAIL_CALL_DISPATCH_PROTOCOL: return 3;
+    case INS_TAIL_CALL_CONTEXTED_FUNCTION: return 2;
+    case INS_TAIL_CALL_FUNCTION: return 2;
+    case INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE: return 3;
+    case INS_JUMP_BACKWARD_IF_STACK_LESS_OR_EQUAL_IMMEDIATE: return 3;
+    case INS_JUMP_BACKWARD_IF_STACK_GREATER_IMMEDIATE: return 3;
+    case INS_JUMP_BACKWARD_IF_STACK_GREATER_OR_EQUAL_IMMEDIATE: return 3;
+    case INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE: return 3;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_IMMEDIATE: return 3;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_OR_EQUAL_IMMEDIATE: return 3;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_IMMEDIATE: return 3;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_OR_EQUAL_IMMEDIATE: return 3;
+    case INS_JUMP_FORWARD_IF_NOT_STACK_EQUAL_IMMEDIATE: return 3;
 }}
 
 #endif
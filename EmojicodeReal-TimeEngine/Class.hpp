@@ -40,6 +40,9 @@ struct Class {
     /// Equivalent to @c alignSize(valueSize + size for instance variables + sizeof(Object))
     size_t size;
     size_t valueSize;
+
+    /// The emoji that names the class or 0 if the class was created by the Engine, e.g. @c CL_ARRAY.
+    EmojicodeChar name = 0;
 };
 
 }
@@ -27,31 +27,36 @@ void dataEqual(Thread *thread) {
     thread->returnFromFunction(memcmp(d->bytes, b->bytes, d->length) == 0);
 }
 
-void dataSize(Thread *thread) {
-    thread->returnFromFunction(thread->thisObject()->val<Data>()->length);
+Value* dataSize(Value thisContext, Value *arguments) {
+    arguments[0] = thisContext.object->val<Data>()->length;
+    return arguments + 1;
 }
 
 void dataMark(Object *o) {
     auto *d = o->val<Data>();
     if (d->bytesObject != nullptr) {
+        // Keep the offset of slices, see dataSlice().
+        auto offset = d->bytes - d->bytesObject->val<char>();
         mark(&d->bytesObject);
-        d->bytes = d->bytesObject->val<char>();
+        d->bytes = d->bytesObject->val<char>() + offset;
     }
 }
 
-void dataGetByte(Thread *thread) {
-    auto *d = thread->thisObject()->val<Data>();
+Value* dataGetByte(Value thisContext, Value *arguments) {
+    auto *d = thisContext.object->val<Data>();
 
-    EmojicodeInteger index = thread->variable(0).raw;
+    EmojicodeInteger index = arguments[0].raw;
     if (index < 0) {
         index += d->length;
     }
     if (index < 0 || d->length <= index) {
-        thread->returnNothingnessFromFunction();
-        return;
+        arguments[0] = T_NOTHINGNESS;
+        return arguments + 2;
     }
 
-    thread->returnOEValueFromFunction(EmojicodeInteger(d->bytes[index]));
+    arguments[0] = T_OPTIONAL_VALUE;
+    arguments[1] = EmojicodeInteger(d->bytes[index]);
+    return arguments + 2;
 }
 
 void dataToString(Thread *thread) {
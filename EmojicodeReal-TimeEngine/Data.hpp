@@ -15,14 +15,21 @@ namespace Emojicode {
 
 struct Data {
     EmojicodeInteger length;
+    /// Points into the value area of @c bytesObject. Slices share the array of the data they were taken from.
     char *bytes;
     Object *bytesObject;
 };
 
+/// Returns true if the bytes of @c data are never moved by the garbage collector, which is the case if they were
+/// allocated with @c newPinnedArray. They may then be accessed while the garbage collector is allowed to run.
+inline bool hasPinnedBytes(const Data *data) {
+    return data->bytesObject == nullptr || isPinned(data->bytesObject);
+}
+
 void dataEqual(Thread *thread);
-void dataSize(Thread *thread);
+Value* dataSize(Value thisContext, Value *arguments);
 void dataMark(Object *o);
-void dataGetByte(Thread *thread);
+Value* dataGetByte(Value thisContext, Value *arguments);
 void dataToString(Thread *thread);
 void dataSlice(Thread *thread);
 void dataIndexOf(Thread *thread);
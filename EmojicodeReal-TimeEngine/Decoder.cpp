@@ -0,0 +1,209 @@
+//
+//  Decoder.cpp
+//  Emojicode
+//
+//  Created by Theo Weidmann on 14/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#include "Decoder.hpp"
+#include "../EmojicodeInstructions.h"
+#include "Processor.hpp"
+#include <cmath>
+#include <vector>
+
+namespace Emojicode {
+
+/// Returns the register operation corresponding to the stack instruction @c instruction, i.e. the @c _RR variant, or
+/// @c 0 if there is none.
+EmojicodeInstruction registerOperation(EmojicodeInstruction instruction) {
+    switch (instruction) {
+        case INS_ADD_INTEGER:
+            return INS_REGISTER_ADD_RR;
+        case INS_SUBTRACT_INTEGER:
+            return INS_REGISTER_SUBTRACT_RR;
+        case INS_MULTIPLY_INTEGER:
+            return INS_REGISTER_MULTIPLY_RR;
+        case INS_DIVIDE_INTEGER:
+            return INS_REGISTER_DIVIDE_RR;
+        case INS_REMAINDER_INTEGER:
+            return INS_REGISTER_REMAINDER_RR;
+        case INS_GREATER_INTEGER:
+            return INS_REGISTER_GREATER_RR;
+        case INS_GREATER_OR_EQUAL_INTEGER:
+            return INS_REGISTER_GREATER_OR_EQUAL_RR;
+        case INS_EQUAL_PRIMITIVE:
+            return INS_REGISTER_EQUAL_RR;
+        default:
+            return 0;
+    }
+}
+
+bool isRegisterSource(EmojicodeInstruction instruction) {
+    return instruction == INS_PUSH_SINGLE_STACK || instruction == INS_GET_32_INTEGER;
+}
+
+void translateToRegisterInstructions(const EmojicodeInstruction *instructions, InstructionCell *cells,
+                                     const std::vector<unsigned int> &starts, const std::vector<bool> &jumpTargets) {
+    // Returns the instruction at the k-th instruction start from i if it is not a jump target.
+    auto at = [&](size_t i, size_t k) -> EmojicodeInstruction {
+        if (i + k >= starts.size() || (k > 0 && jumpTargets[starts[i + k]])) {
+            return 0;
+        }
+        return instructions[starts[i + k]];
+    };
+
+    for (size_t i = 0; i < starts.size(); i++) {
+        auto o = starts[i];
+        if (!isRegisterSource(at(i, 0))) {
+            continue;
+        }
+        auto a = cells[o + 1];
+        bool aIsImmediate = at(i, 0) == INS_GET_32_INTEGER;
+
+        auto operation = registerOperation(at(i, 2));
+        if (isRegisterSource(at(i, 1)) && operation != 0) {
+            auto b = cells[o + 3];
+            bool bIsImmediate = at(i, 1) == INS_GET_32_INTEGER;
+            if (aIsImmediate && bIsImmediate) {
+                continue;
+            }
+            auto form = aIsImmediate ? 4 : (bIsImmediate ? 2 : 0);
+
+            if (at(i, 3) == INS_COPY_TO_STACK) {
+                // PUSH a, PUSH b, OPERATION, COPY_TO_STACK d
+                auto destination = cells[o + 6];
+                cells[o] = instructionCell(operation + form);
+                cells[o + 1] = destination;
+                cells[o + 2] = a;
+                cells[o + 3] = b;
+                i += 3;
+            }
+            else {
+                // PUSH a, PUSH b, OPERATION
+                cells[o] = instructionCell(operation + form + 1);
+                cells[o + 1] = a;
+                cells[o + 2] = b;
+                i += 2;
+            }
+        }
+        else if (at(i, 1) == INS_COPY_TO_STACK) {
+            // PUSH a, COPY_TO_STACK d
+            auto destination = cells[o + 3];
+            cells[o] = instructionCell(aIsImmediate ? INS_REGISTER_MOVE_I : INS_REGISTER_MOVE_R);
+            cells[o + 1] = destination;
+            cells[o + 2] = a;
+            i += 1;
+        }
+    }
+}
+
+void decodeFunction(Function *function) {
+    const EmojicodeInstruction *instructions = function->block.instructions;
+    auto count = function->block.instructionCount;
+    auto *cells = new InstructionCell[count]();
+    std::vector<unsigned int> starts;
+    std::vector<bool> jumpTargets(count + 1);
+
+    // Decodes the jump operand at w into the cell. Jumps are counted from next, the end of the jump instruction.
+    auto decodeJump = [&](InstructionCell *cell, const EmojicodeInstruction *w, unsigned int next, bool backward) {
+        int64_t target = static_cast<int64_t>(next) + (backward ? -1 : 1) * static_cast<int64_t>(w[0]);
+        if (target < 0 || target > count) {
+            error("Bytecode jump leaves the function body");
+        }
+        cell->target = cells + target;
+        jumpTargets[target] = true;
+    };
+
+    for (unsigned int o = 0; o < count;) {
+        starts.push_back(o);
+        auto instruction = static_cast<Instructions>(instructions[o]);
+        cells[o] = instructionCell(instruction);
+
+        auto operands = instruction == INS_CLOSURE ? closureOperandCount(instructions + o) : operandCount(instruction);
+        if (operands < 0) {
+            error("Illegal bytecode instruction");
+        }
+        if (o + operands >= count) {
+            error("Bytecode instruction exceeds the function body");
+        }
+        auto *w = instructions + o + 1;
+        auto *cell = cells + o + 1;
+        for (unsigned int i = 0; i < operands; i++) {
+            cell[i].operand = w[i];
+        }
+
+        switch (instruction) {
+            case INS_CALL_FUNCTION:
+            case INS_CALL_CONTEXTED_FUNCTION:
+            case INS_CLOSURE:
+            case INS_CLOSURE_BOX:
+            case INS_CAPTURE_CONTEXTED_FUNCTION:
+            case INS_INTRINSIC_INTEGER_ABSOLUTE:
+            case INS_INTRINSIC_DOUBLE_SQRT:
+            case INS_INTRINSIC_DOUBLE_FLOOR:
+            case INS_TAIL_CALL_CONTEXTED_FUNCTION:
+            case INS_TAIL_CALL_FUNCTION:
+                cell->function = functionTable[w[0]];
+                break;
+            case INS_DISPATCH_METHOD:
+            case INS_DISPATCH_SUPER:
+            case INS_INTRINSIC_LIST_COUNT:
+            case INS_INTRINSIC_LIST_GET:
+            case INS_INTRINSIC_LIST_SET:
+            case INS_INTRINSIC_LIST_APPEND:
+            case INS_INTRINSIC_STRING_LENGTH:
+            case INS_INTRINSIC_STRING_SYMBOL_AT:
+            case INS_TAIL_CALL_DISPATCH_METHOD:
+                cell->cache = new DispatchCache(w[0], 0);
+                break;
+            case INS_DISPATCH_PROTOCOL:
+            case INS_TAIL_CALL_DISPATCH_PROTOCOL:
+                cell->cache = new DispatchCache(w[1], w[0]);
+                break;
+            case INS_GET_CLASS_FROM_INDEX:
+                cell->klass = classTable[w[0]];
+                break;
+            case INS_GET_32_INTEGER:
+                cell->integer = static_cast<EmojicodeInteger>(w[0]) - INT32_MAX;
+                break;
+            case INS_GET_64_INTEGER:
+                cell->integer = static_cast<EmojicodeInteger>(w[0]) << 32 | w[1];
+                break;
+            case INS_GET_DOUBLE: {
+                EmojicodeInteger scale = (static_cast<EmojicodeInteger>(w[0]) << 32) ^ w[1];
+                cell->doubl = ldexp(static_cast<double>(scale)/PORTABLE_INTLEAST64_MAX, static_cast<int>(w[2]));
+                break;
+            }
+            case INS_JUMP_FORWARD:
+            case INS_JUMP_FORWARD_IF:
+            case INS_JUMP_FORWARD_IF_NOT:
+                decodeJump(cell, w, o + 2, false);
+                break;
+            case INS_JUMP_BACKWARD_IF:
+            case INS_JUMP_BACKWARD_IF_NOT:
+                decodeJump(cell, w, o + 2, true);
+                break;
+            case INS_ADD_INTEGER_IMMEDIATE_TO_STACK:
+                cell[1].integer = static_cast<EmojicodeInteger>(w[1]) - INT32_MAX;
+                break;
+#define STACK_IMMEDIATE_JUMP_CASES(name, op) \
+            case INS_JUMP_BACKWARD_IF_STACK_##name##_IMMEDIATE: \
+            case INS_JUMP_FORWARD_IF_NOT_STACK_##name##_IMMEDIATE:
+            STACK_IMMEDIATE_COMPARISONS(STACK_IMMEDIATE_JUMP_CASES)
+#undef STACK_IMMEDIATE_JUMP_CASES
+                cell[1].integer = static_cast<EmojicodeInteger>(w[1]) - INT32_MAX;
+                decodeJump(cell + 2, w + 2, o + 4, instruction <= INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE);
+                break;
+            default:
+                break;
+        }
+
+        o += operands + 1;
+    }
+
+    translateToRegisterInstructions(instructions, cells, starts, jumpTargets);
+    function->block.cells = cells;
+}
+
+}  // namespace Emojicode
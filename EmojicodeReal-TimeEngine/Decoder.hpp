@@ -0,0 +1,25 @@
+//
+//  Decoder.hpp
+//  Emojicode
+//
+//  Created by Theo Weidmann on 14/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#ifndef Decoder_hpp
+#define Decoder_hpp
+
+#include "Engine.hpp"
+
+namespace Emojicode {
+
+/// Translates the instructions of @c function as read from the bytecode file into the instruction cells executed by
+/// the interpreter: Instructions are replaced with their handlers, operands are widened, constants are unpacked, jump
+/// distances are made absolute, function and class indices are resolved and dispatching call sites get an inline
+/// cache.
+/// @attention All functions and classes must have been read and @c prepareInterpreter() must have been called.
+void decodeFunction(Function *function);
+
+}  // namespace Emojicode
+
+#endif /* Decoder_hpp */
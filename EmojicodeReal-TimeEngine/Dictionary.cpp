@@ -82,8 +82,7 @@ Object* dictionaryNewNode(EmojicodeDictionaryHash hash, RetainedObjectPointer ke
 void dictionaryResize(RetainedObjectPointer dictObject) {
     auto *dict = dictObject->val<EmojicodeDictionary>();
 
-    Object *oldBuckoo = dict->buckets;
-    size_t oldCap = (oldBuckoo == nullptr) ? 0 : dict->bucketsCounter;
+    size_t oldCap = (dict->buckets == nullptr) ? 0 : dict->bucketsCounter;
     size_t oldThr = dict->nextThreshold;
     size_t newCap = oldCap << 1, newThr = 0;
 
@@ -111,6 +110,8 @@ void dictionaryResize(RetainedObjectPointer dictObject) {
 
     Object *newBuckoo = newArray(newCap * sizeof(Object *));
     dict = dictObject->val<EmojicodeDictionary>();
+    // newArray() may have collected garbage and moved the old buckets.
+    Object *oldBuckoo = dict->buckets;
 
     dict->buckets = newBuckoo;
     dict->nextThreshold = newThr;
@@ -170,6 +171,7 @@ void dictionaryResize(RetainedObjectPointer dictObject) {
             }
         }
     }
+    writeBarrier(dictObject.unretainedPointer());
 }
 
 Box* dictionaryPutVal(RetainedObjectPointer dictionaryObject, RetainedObjectPointer key, Thread *thread) {
@@ -196,13 +198,16 @@ Box* dictionaryPutVal(RetainedObjectPointer dictionaryObject, RetainedObjectPoin
         else {
             for (int binCount = 0; ; ++binCount) {
                 if (p->next == nullptr) {
-                    p->next = dictionaryNewNode(hash, key);
-                    destination = thread->retain(p->next);
+                    auto previous = thread->retain(po);
+                    Object *node = dictionaryNewNode(hash, key);
+                    previous->val<EmojicodeDictionaryNode>()->next = node;
+                    thread->release(1);
+                    destination = thread->retain(node);
                     dictionary = dictionaryObject->val<EmojicodeDictionary>();
                     eo = nullptr;
                     break;
                 }
-                eo = p->next;
+                po = eo = p->next;
                 auto *e = eo->val<EmojicodeDictionaryNode>();
 
                 if (dictionaryKeyHashEqual(hash, e->hash, key.unretainedPointer(), e->key)) {
@@ -213,14 +218,18 @@ Box* dictionaryPutVal(RetainedObjectPointer dictionaryObject, RetainedObjectPoin
         }
         if (eo != nullptr) {  // existing mapping for key
             auto *e = eo->val<EmojicodeDictionaryNode>();
+            // The caller stores the value before the next GC-invoking operation.
+            writeBarrier(dictionaryObject.unretainedPointer());
             return &e->value;
         }
     }
     else {
-        buckets[i] = dictionaryNewNode(hash, key);
-        destination = thread->retain(buckets[i]);
+        Object *node = dictionaryNewNode(hash, key);
         dictionary = dictionaryObject->val<EmojicodeDictionary>();
+        dictionary->buckets->val<Object *>()[i] = node;
+        destination = thread->retain(node);
     }
+    writeBarrier(dictionaryObject.unretainedPointer());
 
     if (++dictionary->size > dictionary->nextThreshold) {
         dictionaryResize(dictionaryObject);
@@ -333,6 +342,7 @@ void bridgeDictionaryKeys(Thread *thread) {
     listObject->val<List>()->capacity = dict->size;
     Object *items = newArray(sizeof(Box) * dict->size);
     listObject->val<List>()->items = items;
+    writeBarrier(listObject.unretainedPointer());
 
     for (size_t i = 0, l = dict->bucketsCounter; i < l; i++) {
         auto **bucko = thread->thisObject()->val<EmojicodeDictionary>()->buckets->val<Object*>();
@@ -366,8 +376,9 @@ void bridgeDictionaryContains(Thread *thread) {
     thread->returnFromFunction(dictionaryGetNode(dictionary, key) != nullptr);
 }
 
-void bridgeDictionarySize(Thread *thread) {
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(thread->thisObject()->val<EmojicodeDictionary>()->size));
+Value* bridgeDictionarySize(Value thisContext, Value *arguments) {
+    arguments[0] = static_cast<EmojicodeInteger>(thisContext.object->val<EmojicodeDictionary>()->size);
+    return arguments + 1;
 }
 
 void initDictionaryBridge(Thread *thread) {
@@ -74,7 +74,7 @@ void bridgeDictionaryRemove(Thread *thread);
 void bridgeDictionaryKeys(Thread *thread);
 void bridgeDictionaryClear(Thread *thread);
 void bridgeDictionaryContains(Thread *thread);
-void bridgeDictionarySize(Thread *thread);
+Value* bridgeDictionarySize(Value thisContext, Value *arguments);
 
 }
 
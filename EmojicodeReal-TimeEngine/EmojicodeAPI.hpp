@@ -127,13 +127,27 @@ extern size_t sizeCalculationWithOverflowProtection(size_t items, size_t itemSiz
 extern Object* newArray(size_t size);
 
 /**
- * Tries to resize the given array object to the given size and returns a pointer to the resized array.
+ * Tries to resize the given array object to the given size and returns a pointer to the resized array. An array that
+ * was the last allocation of the calling thread, or the topmost array in the large object space, is grown in place
+ * instead of being copied.
  * @param array An array object created by @c newArray.
  * @param size The new size.
  * @returns A pointer to the resized array.
  * @warning GC-invoking
  */
 extern Object* resizeArray(Object *array, size_t size, Thread *thread);
+/**
+ * Allocates an array like @c newArray that the garbage collector never moves. Its value area may therefore be accessed
+ * between @c allowGC and @c disallowGCAndPauseIfNeeded, e.g. by blocking I/O. The array occupies whole pages and is
+ * thus best suited for buffers of at least a few kilobytes.
+ * @warning GC-invoking
+ */
+extern Object* newPinnedArray(size_t size);
+/**
+ * Returns true if the garbage collector never moves @c object, i.e. if it is an array created by @c newPinnedArray or
+ * a large array created by @c newArray.
+ */
+extern bool isPinned(Object *object);
 
 
 // MARK: Garbage Collection
@@ -143,6 +157,14 @@ extern Object* resizeArray(Object *array, size_t size, Thread *thread);
  * @warning This function will modify @c P to point to an exact copy of @c O after the function call.
  */
 extern void mark(Object **of);
+/**
+ * Must be called after a reference to an object was stored into @c object, either into its value area or into an
+ * array it owns. Arrays created by @c newArray are never scanned on their own, therefore the owning object must be
+ * passed. Call this function after the store and before the next GC-invoking operation.
+ *
+ * The garbage collector relies on this function to find references from old objects to recently allocated ones.
+ */
+extern void writeBarrier(Object *object);
 /**
  * If the calling thread needs to be paused for the GC to run, this function will first
  * unlock @c mutex if it is not a @c nullptr pointer, then block until the GC cycle is completed
@@ -166,6 +188,14 @@ extern void allowGC();
 extern void disallowGCAndPauseIfNeeded();
 
 typedef void (*FunctionFunctionPointer)(Thread *thread);
+/// A native function that is called without a stack frame, directly on the operand stack of the caller. It must not
+/// allocate, call back into Emojicode code or do anything else that might invoke the garbage collector.
+/// @param thisContext The context on which the function was called.
+/// @param arguments The arguments on the operand stack. The result must be stored at this address, which overwrites
+///                  the arguments and possibly the value @c thisContext refers to. Read them first.
+/// @returns The address after the result, which becomes the new top of the operand stack.
+/// @see leafFunctionBridge()
+typedef Value* (*LeafFunctionPointer)(Value thisContext, Value *arguments);
 typedef void (*Marker)(Object *self);
 
 #undef major
@@ -8,6 +8,7 @@
 
 #include "Engine.hpp"
 #include "Class.hpp"
+#include "JIT.hpp"
 #include "Memory.hpp"
 #include "Processor.hpp"
 #include "Reader.hpp"
@@ -82,10 +83,14 @@ int main(int argc, char *argv[]) {
     }
 
     Thread *mainThread = ThreadsManager::allocateThread();
+    ThreadsManager::enterThread(mainThread);
 
     allocateHeap();
+    prepareInterpreter();
+    prepareJIT();
 
     Function *handler = readBytecode(f);
+    loadAheadOfTimeCode(argv[1], readFunctions);
     mainThread->pushStackFrame(Value(), false, handler);
     mainThread->configureInterruption();
     execute(mainThread);
@@ -32,16 +32,45 @@ public:
 struct BoxObjectVariableRecords {
     unsigned int count;
     ObjectVariableRecord *records;
+    /// The class of the objects in which values of this type are stored if they are remotely stored. Its instance
+    /// variable records are @c records so that the garbage collector can scan such an object on its own.
+    Class *storageClass;
+};
+
+struct Function;
+struct DispatchCache;
+struct CompiledFunction;
+
+/// A cell of a pre-decoded instruction stream. See @c decodeFunction().
+union InstructionCell {
+    /// The address of the instruction handler if threaded dispatch is used
+    const void *handler;
+    /// The instruction if the portable dispatch is used
+    EmojicodeInstruction instruction;
+    /// An operand widened to the machine word
+    size_t operand;
+    EmojicodeInteger integer;
+    double doubl;
+    /// The absolute destination of a jump
+    InstructionCell *target;
+    Function *function;
+    Class *klass;
+    DispatchCache *cache;
 };
 
 struct Block {
-    /// A pointer to the first instruction
+    /// A pointer to the first instruction as read from the bytecode file
     EmojicodeInstruction *instructions;
     /// The number of instructions in this block
     unsigned int instructionCount;
+    /// The pre-decoded instructions which are executed by the interpreter. There is exactly one cell per instruction
+    /// in @c instructions so that offsets into @c instructions are valid offsets into @c cells and vice versa.
+    InstructionCell *cells;
 };
 
 struct Function {
+    /// The name of this function encoded as UTF-8, e.g. 🐟.🎺, which identifies it in allocation profiles.
+    const char *name;
     /// Number of arguments taken by this function
     int argumentCount;
 
@@ -56,6 +85,14 @@ struct Function {
 
     /// A native function connect to this function
     FunctionFunctionPointer handler;
+    /// The leaf implementation of the native function, which is called instead of @c handler without a stack frame, or
+    /// @c nullptr.
+    LeafFunctionPointer leafHandler;
+
+    /// The number of times this function was called or jumped backwards in. Used to decide when to compile it.
+    unsigned int hotness;
+    /// The machine code generated by the JIT or @c nullptr if the function was not compiled yet.
+    CompiledFunction *compiled;
 };
 
 struct ProtocolDispatchTable {
@@ -115,6 +152,8 @@ struct Closure {
 typedef void (*PrepareClassFunction)(Class *cl, EmojicodeChar name);
 
 extern FunctionFunctionPointer sLinkingTable[100];
+/// Returns the leaf implementation of the native @c handler from @c sLinkingTable or @c nullptr if there is none.
+LeafFunctionPointer sLeafFunction(FunctionFunctionPointer handler);
 void sPrepareClass(Class *klass, EmojicodeChar name);
 
 }
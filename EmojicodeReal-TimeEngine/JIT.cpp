@@ -0,0 +1,572 @@
+//
+//  JIT.cpp
+//  Emojicode
+//
+//  Created by Theo Weidmann on 21/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#include "JIT.hpp"
+#include "../EmojicodeInstructions.h"
+#include "Memory.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace Emojicode {
+
+bool jitEnabled = false;
+unsigned int jitThreshold = 0;
+
+void prepareJIT() {
+    const char *threshold = getenv("EMOJICODE_JIT");
+    if (threshold != nullptr) {
+        jitEnabled = true;
+        jitThreshold = static_cast<unsigned int>(strtoul(threshold, nullptr, 10));
+    }
+}
+
+void loadAheadOfTimeCode(const char *bytecodePath, const std::vector<Function *> &functions) {
+    std::string path = std::string(bytecodePath) + ".so";
+    if (path.find('/') == std::string::npos) {
+        path = "./" + path;  // dlopen() would search the library paths otherwise
+    }
+    if (access(path.c_str(), F_OK) != 0) {
+        return;
+    }
+    void *library = dlopen(path.c_str(), RTLD_NOW);
+    if (library == nullptr) {
+        error("Could not load compiled code \"%s\": %s", path.c_str(), dlerror());
+    }
+    auto install = reinterpret_cast<void (*)(Function *const *, size_t)>(dlsym(library,
+                                                                                "emojicodeInstallCompiledFunctions"));
+    if (install == nullptr) {
+        error("\"%s\" was not generated by emojicodeaot.", path.c_str());
+    }
+    install(functions.data(), functions.size());
+}
+
+std::mutex compilationMutex;
+
+#ifdef __x86_64__
+
+enum Register { RAX = 0, RCX = 1, RDX = 2, R12 = 12, R13 = 13, R14 = 14 };
+/// Holds a pointer to the first variable of the stack frame
+const Register kVariables = R12;
+/// Holds the operand stack pointer
+const Register kStack = R13;
+/// Holds the address at which the operand stack pointer must be stored before the machine code is left
+const Register kStackPointerAddress = R14;
+
+/// Emits x86-64 machine code. Only the few instruction forms needed by the templates below are supported.
+class Assembler {
+public:
+    std::vector<uint8_t> code;
+
+    void emit(std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); }
+    void emit32(uint32_t value) {
+        for (int i = 0; i < 4; i++) code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+    void emit64(uint64_t value) {
+        for (int i = 0; i < 8; i++) code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    /// Emits an instruction whose r/m operand is the memory at @c base + @c displacement.
+    /// @param wide Whether the instruction operates on 64 bits, i.e. requires REX.W.
+    /// @param prefix A mandatory prefix like @c 0xF2 for scalar double instructions or @c 0
+    void memory(std::initializer_list<uint8_t> opcode, int reg, Register base, int32_t displacement,
+                bool wide = true, uint8_t prefix = 0) {
+        if (prefix != 0) {
+            emit({prefix});
+        }
+        uint8_t rex = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) != 0 ? 0x04 : 0) | ((base & 8) != 0 ? 0x01 : 0);
+        if (rex != 0x40) {
+            emit({rex});
+        }
+        emit(opcode);
+        emit({static_cast<uint8_t>(0x80 | (reg & 7) << 3 | (base & 7))});
+        if ((base & 7) == 4) {
+            emit({0x24});  // SIB byte required for RSP/R12 as base
+        }
+        emit32(static_cast<uint32_t>(displacement));
+    }
+
+    void load(int reg, Register base, int32_t displacement) { memory({0x8B}, reg, base, displacement); }
+    void store(Register base, int32_t displacement, int reg) { memory({0x89}, reg, base, displacement); }
+    void moveImmediate(Register reg, uint64_t value) {
+        emit({0x48, static_cast<uint8_t>(0xB8 + reg)});
+        emit64(value);
+    }
+    /// Adds @c bytes to the operand stack pointer.
+    void adjustStack(int32_t bytes) {
+        if (bytes != 0) {
+            emit({0x49, 0x81, 0xC5});
+            emit32(static_cast<uint32_t>(bytes));
+        }
+    }
+    /// Pushes RAX onto the operand stack.
+    void push() {
+        store(kStack, 0, RAX);
+        adjustStack(sizeof(Value));
+    }
+    /// Sets RAX to 1 if the condition code @c cc of the SETcc instruction is met and 0 otherwise.
+    void setRAX(uint8_t cc) { emit({0x0F, cc, 0xC0, 0x0F, 0xB6, 0xC0}); }
+};
+
+const uint8_t kSetGreater = 0x9F;
+const uint8_t kSetGreaterOrEqual = 0x9D;
+const uint8_t kSetEqual = 0x94;
+const uint8_t kSetAbove = 0x97;
+const uint8_t kSetAboveOrEqual = 0x93;
+
+/// Generates the machine code for one function.
+class FunctionCompiler {
+public:
+    explicit FunctionCompiler(Function *function) : function_(function), block_(function->block),
+        labels_(block_.instructionCount + 1, 0), compiled_(block_.instructionCount, false) {}
+
+    CompiledFunction* compile();
+private:
+    struct Fixup {
+        size_t position;
+        unsigned int target;
+    };
+
+    Function *function_;
+    const Block &block_;
+    Assembler a_;
+    std::vector<size_t> labels_;
+    std::vector<bool> compiled_;
+    std::vector<Fixup> fixups_;
+    std::vector<size_t> exits_;
+
+    static const unsigned int kEpilogue = UINT32_MAX;
+
+    /// Emits a jump with a 32-bit displacement to the instruction at @c target.
+    void jump(std::initializer_list<uint8_t> opcode, unsigned int target) {
+        a_.emit(opcode);
+        fixups_.push_back(Fixup{a_.code.size(), target});
+        a_.emit32(0);
+    }
+    void exit(unsigned int offset) {
+        a_.moveImmediate(RAX, reinterpret_cast<uint64_t>(block_.cells + offset));
+        jump({0xE9}, kEpilogue);
+    }
+
+    /// Emits a safepoint poll for the backward jump at @c offset: The machine code is left at the jump if the garbage
+    /// collector is waiting for threads to pause, so that the interpreter pauses when it executes the jump.
+    void poll(unsigned int offset) {
+        static_assert(sizeof(pauseThreads) == 1, "The poll compares a single byte");
+        a_.moveImmediate(RAX, reinterpret_cast<uint64_t>(&pauseThreads));
+        a_.emit({0x80, 0x38, 0x00});  // CMP BYTE PTR [RAX], 0
+        a_.emit({0x74, 15});  // JE over the exit
+        exit(offset);
+    }
+
+    void binaryIntegerOperation(std::initializer_list<uint8_t> opcode) {
+        a_.load(RAX, kStack, -16);
+        a_.memory(opcode, RAX, kStack, -8);
+        a_.store(kStack, -16, RAX);
+        a_.adjustStack(-8);
+    }
+    void compareInteger(uint8_t cc) {
+        a_.load(RAX, kStack, -16);
+        a_.memory({0x3B}, RAX, kStack, -8);
+        a_.setRAX(cc);
+        a_.store(kStack, -16, RAX);
+        a_.adjustStack(-8);
+    }
+    void shiftInteger(uint8_t modRM) {
+        a_.load(RAX, kStack, -16);
+        a_.load(RCX, kStack, -8);
+        a_.emit({0x48, 0xD3, modRM});
+        a_.store(kStack, -16, RAX);
+        a_.adjustStack(-8);
+    }
+    void divideInteger(Register result) {
+        a_.load(RAX, kStack, -16);
+        a_.emit({0x48, 0x99});  // CQO
+        a_.memory({0xF7}, 7, kStack, -8);  // IDIV
+        a_.store(kStack, -16, result);
+        a_.adjustStack(-8);
+    }
+    void binaryDoubleOperation(uint8_t opcode) {
+        a_.memory({0x0F, 0x10}, 0, kStack, -16, false, 0xF2);
+        a_.memory({0x0F, opcode}, 0, kStack, -8, false, 0xF2);
+        a_.memory({0x0F, 0x11}, 0, kStack, -16, false, 0xF2);
+        a_.adjustStack(-8);
+    }
+    void compareDouble(uint8_t cc) {
+        a_.memory({0x0F, 0x10}, 0, kStack, -16, false, 0xF2);
+        a_.memory({0x0F, 0x2E}, 0, kStack, -8, false, 0x66);  // UCOMISD
+        a_.setRAX(cc);
+        a_.store(kStack, -16, RAX);
+        a_.adjustStack(-8);
+    }
+    void conditionalJump(uint8_t jcc, unsigned int target) {
+        a_.load(RAX, kStack, -8);
+        a_.adjustStack(-8);
+        a_.emit({0x48, 0x85, 0xC0});  // TEST RAX, RAX
+        jump({0x0F, jcc}, target);
+    }
+    /// Compares the variable at @c w[0] with the immediate at @c w[1] and jumps to @c target if @c jcc is met.
+    void compareStackImmediateJump(const EmojicodeInstruction *w, uint8_t jcc, unsigned int target) {
+        a_.memory({0x81}, 7, kVariables, w[0] * sizeof(Value));  // CMP
+        a_.emit32(static_cast<uint32_t>(static_cast<int64_t>(w[1]) - INT32_MAX));
+        jump({0x0F, jcc}, target);
+    }
+
+    /// Emits the machine code for the instruction at @c offset.
+    /// @returns False if the instruction is not supported. Nothing has been emitted in that case.
+    bool compileInstruction(unsigned int offset, unsigned int next);
+};
+
+bool FunctionCompiler::compileInstruction(unsigned int offset, unsigned int next) {
+    const EmojicodeInstruction *w = block_.instructions + offset + 1;
+    const InstructionCell *cell = block_.cells + offset + 1;
+    switch (static_cast<Instructions>(block_.instructions[offset])) {
+        case INS_PUSH_SINGLE_STACK:
+            a_.load(RAX, kVariables, w[0] * sizeof(Value));
+            a_.push();
+            return true;
+        case INS_COPY_TO_STACK:
+            a_.load(RAX, kStack, -8);
+            a_.store(kVariables, w[0] * sizeof(Value), RAX);
+            a_.adjustStack(-8);
+            return true;
+        case INS_PUSH_WITH_SIZE_STACK:
+            for (unsigned int i = 0; i < w[1]; i++) {
+                a_.load(RAX, kVariables, (w[0] + i) * sizeof(Value));
+                a_.store(kStack, i * sizeof(Value), RAX);
+            }
+            a_.adjustStack(w[1] * sizeof(Value));
+            return true;
+        case INS_COPY_TO_STACK_SIZE:
+            for (unsigned int i = 0; i < w[0]; i++) {
+                a_.load(RAX, kStack, (static_cast<int32_t>(i) - static_cast<int32_t>(w[0])) * sizeof(Value));
+                a_.store(kVariables, (w[1] + i) * sizeof(Value), RAX);
+            }
+            a_.adjustStack(-static_cast<int32_t>(w[0] * sizeof(Value)));
+            return true;
+        case INS_PUSH_VT_REFERENCE_STACK:
+            a_.memory({0x8D}, RAX, kVariables, w[0] * sizeof(Value));  // LEA
+            a_.push();
+            return true;
+        case INS_PUSH_STACK_REFERENCE_N_BACK:
+            a_.memory({0x8D}, RAX, kStack, -static_cast<int32_t>(w[0] * sizeof(Value)));  // LEA
+            a_.push();
+            return true;
+        case INS_PUSH_VALUE_FROM_REFERENCE:
+            a_.load(RCX, kStack, -8);
+            a_.adjustStack(-8);
+            for (unsigned int i = 0; i < w[0]; i++) {
+                a_.load(RAX, RCX, i * sizeof(Value));
+                a_.store(kStack, i * sizeof(Value), RAX);
+            }
+            a_.adjustStack(w[0] * sizeof(Value));
+            return true;
+        case INS_THIS:
+            a_.load(RAX, kVariables, -8);
+            a_.push();
+            return true;
+        case INS_PUSH_N:
+            a_.adjustStack(w[0] * sizeof(Value));
+            return true;
+        case INS_POP:
+            a_.adjustStack(-8);
+            return true;
+        case INS_GET_32_INTEGER:
+            // The cell might have been overwritten by a register instruction
+            a_.moveImmediate(RAX, static_cast<uint64_t>(static_cast<EmojicodeInteger>(w[0]) - INT32_MAX));
+            a_.push();
+            return true;
+        case INS_GET_64_INTEGER:
+            a_.moveImmediate(RAX, static_cast<uint64_t>(cell->integer));
+            a_.push();
+            return true;
+        case INS_GET_DOUBLE: {
+            uint64_t bits;
+            std::memcpy(&bits, &cell->doubl, sizeof(bits));
+            a_.moveImmediate(RAX, bits);
+            a_.push();
+            return true;
+        }
+        case INS_GET_TRUE:
+            a_.moveImmediate(RAX, 1);
+            a_.push();
+            return true;
+        case INS_GET_FALSE:
+            a_.moveImmediate(RAX, 0);
+            a_.push();
+            return true;
+        case INS_GET_NOTHINGNESS:
+            a_.moveImmediate(RAX, T_NOTHINGNESS);
+            a_.push();
+            return true;
+        case INS_GET_SYMBOL:
+            // Like the interpreter only the character is written
+            a_.memory({0xC7}, 0, kStack, 0, false);
+            a_.emit32(w[0]);
+            a_.adjustStack(8);
+            return true;
+        case INS_GET_CLASS_FROM_INDEX:
+            a_.moveImmediate(RAX, reinterpret_cast<uint64_t>(cell->klass));
+            a_.push();
+            return true;
+        case INS_GET_STRING_POOL:
+            // The string might be moved by the garbage collector
+            a_.moveImmediate(RAX, reinterpret_cast<uint64_t>(stringPool + w[0]));
+            a_.emit({0x48, 0x8B, 0x00});
+            a_.push();
+            return true;
+        case INS_ADD_INTEGER:
+            binaryIntegerOperation({0x03});
+            return true;
+        case INS_SUBTRACT_INTEGER:
+            binaryIntegerOperation({0x2B});
+            return true;
+        case INS_MULTIPLY_INTEGER:
+            binaryIntegerOperation({0x0F, 0xAF});
+            return true;
+        case INS_BINARY_AND_INTEGER:
+            binaryIntegerOperation({0x23});
+            return true;
+        case INS_BINARY_OR_INTEGER:
+            binaryIntegerOperation({0x0B});
+            return true;
+        case INS_BINARY_XOR_INTEGER:
+            binaryIntegerOperation({0x33});
+            return true;
+        case INS_DIVIDE_INTEGER:
+            divideInteger(RAX);
+            return true;
+        case INS_REMAINDER_INTEGER:
+            divideInteger(RDX);
+            return true;
+        case INS_SHIFT_LEFT_INTEGER:
+            shiftInteger(0xE0);
+            return true;
+        case INS_SHIFT_RIGHT_INTEGER:
+            shiftInteger(0xF8);
+            return true;
+        case INS_BINARY_NOT_INTEGER:
+            a_.load(RAX, kStack, -8);
+            a_.emit({0x48, 0xF7, 0xD0});
+            a_.store(kStack, -8, RAX);
+            return true;
+        case INS_GREATER_INTEGER:
+            compareInteger(kSetGreater);
+            return true;
+        case INS_GREATER_OR_EQUAL_INTEGER:
+            compareInteger(kSetGreaterOrEqual);
+            return true;
+        case INS_EQUAL_PRIMITIVE:
+        case INS_SAME_OBJECT:
+            compareInteger(kSetEqual);
+            return true;
+        case INS_EQUAL_SYMBOL:
+            a_.memory({0x8B}, RAX, kStack, -16, false);
+            a_.memory({0x3B}, RAX, kStack, -8, false);
+            a_.setRAX(kSetEqual);
+            a_.store(kStack, -16, RAX);
+            a_.adjustStack(-8);
+            return true;
+        case INS_INVERT_BOOLEAN:
+            a_.load(RAX, kStack, -8);
+            a_.emit({0x48, 0x85, 0xC0});
+            a_.setRAX(kSetEqual);
+            a_.store(kStack, -8, RAX);
+            return true;
+        case INS_ADD_DOUBLE:
+            binaryDoubleOperation(0x58);
+            return true;
+        case INS_SUBTRACT_DOUBLE:
+            binaryDoubleOperation(0x5C);
+            return true;
+        case INS_MULTIPLY_DOUBLE:
+            binaryDoubleOperation(0x59);
+            return true;
+        case INS_DIVIDE_DOUBLE:
+            binaryDoubleOperation(0x5E);
+            return true;
+        case INS_GREATER_DOUBLE:
+            compareDouble(kSetAbove);
+            return true;
+        case INS_GREATER_OR_EQUAL_DOUBLE:
+            compareDouble(kSetAboveOrEqual);
+            return true;
+        case INS_EQUAL_DOUBLE:
+            a_.memory({0x0F, 0x10}, 0, kStack, -16, false, 0xF2);
+            a_.memory({0x0F, 0x2E}, 0, kStack, -8, false, 0x66);
+            // Unordered operands set ZF too, hence the parity must be checked
+            a_.emit({0x0F, kSetEqual, 0xC0, 0x0F, 0x9B, 0xC1, 0x20, 0xC8, 0x0F, 0xB6, 0xC0});
+            a_.store(kStack, -16, RAX);
+            a_.adjustStack(-8);
+            return true;
+        case INS_INT_TO_DOUBLE:
+            a_.memory({0x0F, 0x2A}, 0, kStack, -8, true, 0xF2);
+            a_.memory({0x0F, 0x11}, 0, kStack, -8, false, 0xF2);
+            return true;
+        case INS_IS_NOTHINGNESS:
+        case INS_IS_ERROR:
+            a_.load(RCX, kStack, -8);
+            a_.load(RAX, RCX, 0);
+            a_.emit({0x48, 0x83, 0xF8,
+                static_cast<uint8_t>(block_.instructions[offset] == INS_IS_ERROR ? T_ERROR : T_NOTHINGNESS)});
+            a_.setRAX(kSetEqual);
+            a_.store(kStack, -8, RAX);
+            return true;
+        case INS_JUMP_FORWARD:
+            jump({0xE9}, next + w[0]);
+            return true;
+        case INS_JUMP_FORWARD_IF:
+            conditionalJump(0x85, next + w[0]);
+            return true;
+        case INS_JUMP_FORWARD_IF_NOT:
+            conditionalJump(0x84, next + w[0]);
+            return true;
+        case INS_JUMP_BACKWARD_IF:
+            poll(offset);
+            conditionalJump(0x85, next - w[0]);
+            return true;
+        case INS_JUMP_BACKWARD_IF_NOT:
+            poll(offset);
+            conditionalJump(0x84, next - w[0]);
+            return true;
+        case INS_INCREMENT:
+            a_.memory({0xFF}, 0, kVariables, w[0] * sizeof(Value));  // INC
+            return true;
+        case INS_DECREMENT:
+            a_.memory({0xFF}, 1, kVariables, w[0] * sizeof(Value));  // DEC
+            return true;
+        case INS_ADD_INTEGER_IMMEDIATE_TO_STACK:
+            a_.memory({0x81}, 0, kVariables, w[0] * sizeof(Value));  // ADD
+            a_.emit32(static_cast<uint32_t>(static_cast<int64_t>(w[1]) - INT32_MAX));
+            return true;
+        case INS_JUMP_BACKWARD_IF_STACK_LESS_IMMEDIATE:
+            poll(offset);
+            compareStackImmediateJump(w, 0x8C, next - w[2]);
+            return true;
+        case INS_JUMP_BACKWARD_IF_STACK_LESS_OR_EQUAL_IMMEDIATE:
+            poll(offset);
+            compareStackImmediateJump(w, 0x8E, next - w[2]);
+            return true;
+        case INS_JUMP_BACKWARD_IF_STACK_GREATER_IMMEDIATE:
+            poll(offset);
+            compareStackImmediateJump(w, 0x8F, next - w[2]);
+            return true;
+        case INS_JUMP_BACKWARD_IF_STACK_GREATER_OR_EQUAL_IMMEDIATE:
+            poll(offset);
+            compareStackImmediateJump(w, 0x8D, next - w[2]);
+            return true;
+        case INS_JUMP_BACKWARD_IF_STACK_EQUAL_IMMEDIATE:
+            poll(offset);
+            compareStackImmediateJump(w, 0x84, next - w[2]);
+            return true;
+        case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_IMMEDIATE:
+            compareStackImmediateJump(w, 0x8D, next + w[2]);
+            return true;
+        case INS_JUMP_FORWARD_IF_NOT_STACK_LESS_OR_EQUAL_IMMEDIATE:
+            compareStackImmediateJump(w, 0x8F, next + w[2]);
+            return true;
+        case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_IMMEDIATE:
+            compareStackImmediateJump(w, 0x8E, next + w[2]);
+            return true;
+        case INS_JUMP_FORWARD_IF_NOT_STACK_GREATER_OR_EQUAL_IMMEDIATE:
+            compareStackImmediateJump(w, 0x8C, next + w[2]);
+            return true;
+        case INS_JUMP_FORWARD_IF_NOT_STACK_EQUAL_IMMEDIATE:
+            compareStackImmediateJump(w, 0x85, next + w[2]);
+            return true;
+        default:
+            return false;
+    }
+}
+
+CompiledFunction* FunctionCompiler::compile() {
+    // Prologue: RDI = variables, RSI = operand stack pointer address, RDX = entry
+    a_.emit({0x41, 0x54, 0x41, 0x55, 0x41, 0x56});  // PUSH R12, R13, R14
+    a_.emit({0x49, 0x89, 0xFC});  // MOV R12, RDI
+    a_.emit({0x49, 0x89, 0xF6});  // MOV R14, RSI
+    a_.emit({0x4D, 0x8B, 0x2E});  // MOV R13, [R14]
+    a_.emit({0xFF, 0xE2});  // JMP RDX
+
+    bool anyCompiled = false;
+    for (unsigned int offset = 0; offset < block_.instructionCount;) {
+        auto instruction = static_cast<Instructions>(block_.instructions[offset]);
+        auto next = offset + 1 + (instruction == INS_CLOSURE ? closureOperandCount(block_.instructions + offset)
+                                                             : operandCount(instruction));
+        labels_[offset] = a_.code.size();
+        if (compileInstruction(offset, next)) {
+            compiled_[offset] = true;
+            anyCompiled = true;
+        }
+        else {
+            exit(offset);
+        }
+        offset = next;
+    }
+    labels_[block_.instructionCount] = a_.code.size();
+    exit(block_.instructionCount);
+
+    auto epilogue = a_.code.size();
+    a_.emit({0x4D, 0x89, 0x2E});  // MOV [R14], R13
+    a_.emit({0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C});  // POP R14, R13, R12
+    a_.emit({0xC3});
+
+    auto compiledFunction = new CompiledFunction();
+    if (!anyCompiled) {
+        return compiledFunction;
+    }
+
+    for (auto &fixup : fixups_) {
+        auto target = fixup.target == kEpilogue ? epilogue : labels_[fixup.target];
+        auto displacement = static_cast<int32_t>(target - (fixup.position + 4));
+        std::memcpy(&a_.code[fixup.position], &displacement, sizeof(displacement));
+    }
+
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto size = (a_.code.size() + pageSize - 1) / pageSize * pageSize;
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return compiledFunction;
+    }
+    std::memcpy(memory, a_.code.data(), a_.code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return compiledFunction;
+    }
+
+    auto base = static_cast<uint8_t *>(memory);
+    auto entries = new const void*[block_.instructionCount]();
+    for (unsigned int offset = 0; offset < block_.instructionCount; offset++) {
+        if (compiled_[offset]) {
+            entries[offset] = base + labels_[offset];
+        }
+    }
+    compiledFunction->run = reinterpret_cast<InstructionCell* (*)(Value *, Value **, const void *)>(memory);
+    compiledFunction->entries = entries;
+    return compiledFunction;
+}
+
+#endif
+
+void compileFunction(Function *function) {
+    std::lock_guard<std::mutex> lock(compilationMutex);
+    if (function->compiled != nullptr) {
+        return;
+    }
+#ifdef __x86_64__
+    function->compiled = FunctionCompiler(function).compile();
+#else
+    function->compiled = new CompiledFunction();
+#endif
+}
+
+}  // namespace Emojicode
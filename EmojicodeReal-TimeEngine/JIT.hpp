@@ -0,0 +1,51 @@
+//
+//  JIT.hpp
+//  Emojicode
+//
+//  Created by Theo Weidmann on 21/08/2017.
+//  Copyright © 2017 Theo Weidmann. All rights reserved.
+//
+
+#ifndef JIT_hpp
+#define JIT_hpp
+
+#include "Engine.hpp"
+#include <vector>
+
+namespace Emojicode {
+
+/// The machine code the JIT generated for a function.
+///
+/// The machine code operates directly on the frame variables and the operand stack of the thread. It is entered at
+/// an instruction offset and runs until it reaches an instruction it was not able to compile, e.g. a call or a return.
+/// It then returns the execution pointer of that instruction and the interpreter takes over.
+struct CompiledFunction {
+    /// Runs the machine code starting at @c entry, which must be taken from @c entries.
+    /// @returns The execution pointer at which the interpreter must continue.
+    InstructionCell* (*run)(Value *variables, Value **operandStackPointer, const void *entry);
+    /// The address of the machine code of the instruction at each offset or @c nullptr if the instruction was not
+    /// compiled. @c nullptr if nothing at all was compiled.
+    const void **entries;
+};
+
+/// Whether the JIT is enabled. It is enabled by setting the environment variable @c EMOJICODE_JIT to the number of
+/// calls and backward jumps after which a function is compiled.
+extern bool jitEnabled;
+/// See @c jitEnabled.
+extern unsigned int jitThreshold;
+
+/// Reads the JIT configuration from the environment.
+void prepareJIT();
+
+/// Installs the machine code emojicodeaot generated for the bytecode file at @c bytecodePath if a shared object named
+/// like the bytecode file with ".so" appended exists. Functions whose bytecode changed since are not affected.
+/// @param functions All functions in the order in which they appear in the bytecode file.
+void loadAheadOfTimeCode(const char *bytecodePath, const std::vector<Function *> &functions);
+
+/// Compiles @c function and sets @c Function::compiled. The function must not have been compiled before.
+/// The JIT is only available on x86-64. On other architectures the result never contains entries.
+void compileFunction(Function *function);
+
+}  // namespace Emojicode
+
+#endif /* JIT_hpp */
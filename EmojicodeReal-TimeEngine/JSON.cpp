@@ -81,7 +81,7 @@ void stringJSON(Thread *thread) {
                         continue;
                     case '"': {
                         auto stringObject = thread->retain(newObject(CL_STRING));
-                        initStringFromSymbolList(stringObject->val<String>(), stackCurrent->object->val<List>());
+                        initStringFromSymbolList(stringObject, stackCurrent->object);
                         thread->release(1);
                         backValue = Box(T_OBJECT, stringObject.unretainedPointer());
                         popTheStack();
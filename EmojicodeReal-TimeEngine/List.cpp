@@ -33,6 +33,7 @@ void expandListSize(RetainedObjectPointer listObject, Thread *thread) {
         list->items = object;
         list->capacity = newSize;
     }
+    writeBarrier(listObject.unretainedPointer());
 #undef initialSize
 }
 
@@ -49,6 +50,7 @@ void listEnsureCapacity(Thread *thread, size_t size) {
         list = thread->thisObject()->val<List>();
         list->items = object;
         list->capacity = size;
+        writeBarrier(thread->thisObject());
     }
 }
 
@@ -68,9 +70,18 @@ Box* listAppendDestination(RetainedObjectPointer listObject, Thread *thread) {
         expandListSize(listObject, thread);
     }
     list = listObject->val<List>();
+    // The caller stores the element before the next GC-invoking operation.
+    writeBarrier(listObject.unretainedPointer());
     return list->elements() + list->count++;
 }
 
+void listAppendObject(RetainedObjectPointer listObject, Object *object, Thread *thread) {
+    auto retainedObject = thread->retain(object);
+    Box *destination = listAppendDestination(listObject, thread);
+    destination->copySingleValue(T_OBJECT, retainedObject.unretainedPointer());
+    thread->release(1);
+}
+
 void listAppendList(Thread *thread) {
     auto *copyList = thread->variable(0).object->val<List>();
     listEnsureCapacity(thread, thread->thisObject()->val<List>()->count + copyList->count);
@@ -78,10 +89,12 @@ void listAppendList(Thread *thread) {
     copyList = thread->variable(0).object->val<List>();
     std::memcpy(list->elements() + list->count, copyList->elements(), copyList->count * sizeof(Box));
     list->count += copyList->count;
+    writeBarrier(thread->thisObject());
 }
 
-void listCountBridge(Thread *thread) {
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(thread->thisObject()->val<List>()->count));
+Value* listCountBridge(Value thisContext, Value *arguments) {
+    arguments[0] = static_cast<EmojicodeInteger>(thisContext.object->val<List>()->count);
+    return arguments + 1;
 }
 
 void listAppendBridge(Thread *thread) {
@@ -90,17 +103,22 @@ void listAppendBridge(Thread *thread) {
     thread->returnFromFunction();
 }
 
-void listGetBridge(Thread *thread) {
-    auto *list = thread->thisObject()->val<List>();
-    EmojicodeInteger index = thread->variable(0).raw;
+Value* listGetBridge(Value thisContext, Value *arguments) {
+    auto *list = thisContext.object->val<List>();
+    EmojicodeInteger index = arguments[0].raw;
     if (index < 0) {
         index += list->count;
     }
     if (index < 0 || list->count <= index) {
-        thread->returnBoxNothingnessFromFunction();
-        return;
+        arguments[0] = T_NOTHINGNESS;
+        return arguments + kBoxValueSize;
     }
-    thread->returnFromFunction(list->elements()[index]);
+    const Box &box = list->elements()[index];
+    arguments[0] = box.type;
+    arguments[1] = box.value1;
+    arguments[2] = box.value2;
+    arguments[3] = box.value3;
+    return arguments + kBoxValueSize;
 }
 
 void listRemoveBridge(Thread *thread) {
@@ -150,6 +168,7 @@ void listInsertBridge(Thread *thread) {
 
     std::memmove(list->elements() + index + 1, list->elements() + index, sizeof(Box) * (list->count++ - index));
     list->elements()[index].copy(thread->variableDestination(1));
+    writeBarrier(thread->thisObject());
     thread->returnFromFunction();
 }
 
@@ -180,6 +199,7 @@ void listFromListBridge(Thread *thread) {
     list->items = items;
 
     std::memcpy(list->elements(), originalList->elements(), originalList->count * sizeof(Box));
+    writeBarrier(listO.unretainedPointer());
     thread->release(1);
     thread->returnFromFunction(listO.unretainedPointer());
 }
@@ -201,6 +221,7 @@ void listSetBridge(Thread *thread) {
     }
 
     list->elements()[index].copy(thread->variableDestination(1));
+    writeBarrier(thread->thisObject());
     thread->returnFromFunction();
 }
 
@@ -229,6 +250,7 @@ void initListWithCapacity(Thread *thread) {
     auto *list = thread->thisObject()->val<List>();
     list->capacity = capacity;
     list->items = n;
+    writeBarrier(thread->thisObject());
     thread->returnFromFunction(thread->thisContext());
 }
 
@@ -31,14 +31,16 @@ struct List {
 /// Prepares the list for a new element to be added to the end and returns a pointer to where the new element should be
 /// copied.
 Box* listAppendDestination(RetainedObjectPointer listObject, Thread *thread);
+/// Appends @c object to the list. @c object is retained while the list grows.
+void listAppendObject(RetainedObjectPointer listObject, Object *object, Thread *thread);
 
 void listMark(Object *self);
 
 void initListEmptyBridge(Thread *thread);
 void initListWithCapacity(Thread *thread);
-void listCountBridge(Thread *thread);
+Value* listCountBridge(Value thisContext, Value *arguments);
 void listAppendBridge(Thread *thread);
-void listGetBridge(Thread *thread);
+Value* listGetBridge(Value thisContext, Value *arguments);
 void listRemoveBridge(Thread *thread);
 void listPopBridge(Thread *thread);
 void listInsertBridge(Thread *thread);
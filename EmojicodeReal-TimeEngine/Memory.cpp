@@ -10,29 +10,293 @@
 #include "Class.hpp"
 #include "Engine.hpp"
 #include "Thread.hpp"
+#include "ThreadsManager.hpp"
+#include "utf8.h"
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
+#include <csignal>
+#include <map>
+#include <tuple>
+#include <string>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <atomic>
 
 namespace Emojicode {
 
-std::atomic_size_t memoryUse(0);
-bool zeroingNeeded = false;
-Byte *currentHeap;
-Byte *otherHeap;
+/// The nursery, in which objects are allocated by bumping @c nurseryUse. Objects surviving a garbage collection are
+/// promoted to the old generation, which leaves the nursery empty but for pinned objects.
+Byte *nursery;
+/// The size of the nursery, a sixteenth of the heap. It grows with the heap.
+size_t nurserySize;
+std::atomic_size_t nurseryUse(0);
+/// The number of bytes of the nursery that may be used before the next garbage collection. It never exceeds the free
+/// space of the old generation so that all objects in the nursery can be promoted.
+size_t nurseryLimit = 0;
 
-Object **deinitializationList;
-std::atomic_size_t deinitializationListIndex(0);
-std::atomic_size_t deinitializationListSize(7);
-std::mutex deinitializationListResizeMutex;
+/// The size of the heap, which grows up to @c maxHeapSize when the survivors of a major collection fill more than half
+/// of the old generation.
+size_t currentHeapSize;
+size_t maxHeapSize;
+/// The percentage by which the heap grows.
+size_t heapGrowth = 100;
+size_t pageSize;
+/// The size of the address space reserved for the nursery.
+size_t maxNurserySize;
+size_t maxOldSpaceSize;
+/// The size of each semispace of the old generation. Only this many bytes of the address space reserved for a
+/// semispace are accessible.
+size_t oldSpaceSize;
 
-void gc(std::unique_lock<std::mutex> &garbageCollectionLock, size_t minSpace);
+Byte *oldGeneration;
+/// The semispace of the old generation into which the live objects are copied by the next major collection.
+Byte *otherOldSpace;
+std::atomic_size_t oldGenerationUse(0);
+Byte *cardTable;
+/// The object covering the first byte of each card, from which the objects on a dirty card are found.
+Object **cardObjects;
+/// The card objects of @c otherOldSpace, which let a major collection find the object an interior pointer points into.
+Object **otherCardObjects;
+/// The object covering the first byte of each card of the nursery. They are only determined once a minor collection
+/// needs to find the object an interior pointer points into, see @c indexNursery().
+Object **nurseryCardObjects;
+std::atomic_bool nurseryIndexed(false);
+std::mutex nurseryIndexMutex;
 
-size_t gcThreshold = heapSize / 2;
+/// The objects of the nursery that the last garbage collection pinned, sorted by address. They are left in place
+/// between filler objects and moved by the next collection unless it pins them again. @see pinOperandReferents()
+std::vector<Object *> pinnedNurseryObjects;
+/// The end of the last object in @c pinnedNurseryObjects or 0. Objects are allocated in the nursery from here on.
+size_t nurseryPinnedEnd = 0;
+/// The objects the last major collection pinned. They lie in @c otherOldSpace, outside the old generation, until the
+/// next major collection copies into @c otherOldSpace around them. Until then, every collection scans them as roots.
+std::vector<Object *> pinnedOldObjects;
+
+/// Whether the running collection collects the old generation. Only the nursery is collected otherwise.
+bool majorCollection = false;
+
+/// The pause budget set with @c EMOJICODE_GC_PAUSE. If it is not zero, the old generation is collected incrementally
+/// by marking and sweeping it in slices, each run at the end of a minor collection. A major collection, which copies
+/// the old generation while all threads are paused, only happens if the old generation runs out of space.
+std::chrono::microseconds pauseBudget(0);
+
+enum class IncrementalPhase {
+    Idle, Marking, Sweeping,
+};
+
+IncrementalPhase incrementalPhase = IncrementalPhase::Idle;
+/// Whether mark() marks objects of the old generation for the incremental collection instead of copying objects.
+bool markingOldGeneration = false;
+/// One bit for every word of the old generation, which is set if the object starting there was found reachable.
+Byte *markBits;
+/// Marked objects whose references have not been marked yet.
+std::vector<Object *> markStack;
+/// The number of bytes used in the old generation when the marking began. The objects beyond were promoted or
+/// allocated since and count as marked. They are scanned up to @c scannedOffset.
+size_t markStart;
+size_t scannedOffset;
+/// A byte for every card of the old generation that is set if the card was dirty since the incremental marking began.
+/// Unlike the card table, it is not cleared by minor collections.
+Byte *modUnionTable;
+/// The cards set in @c modUnionTable, so that rescanning them takes time proportional to their number instead of to the
+/// size of the old generation.
+std::vector<size_t> modUnionCards;
+/// The number of pauses in which the remark of the running incremental marking exhausted the budget.
+unsigned int remarkAttempts;
+/// After this many attempts, the remark completes regardless of the budget so that the marking terminates even if the
+/// threads keep dirtying cards and pushing new objects onto their stacks.
+const unsigned int kMaxRemarkAttempts = 4;
+/// The part of the old generation that the running sweep frees the unmarked objects of, and how far it got.
+size_t sweepLimit;
+size_t sweepOffset;
+/// Chunks of the old generation freed by sweeping, into which promotion buffers are carved. They are aligned to cards
+/// and no reachable object lies on their cards, so minor collections never walk them while scanning dirty cards.
+std::vector<std::pair<Byte *, Byte *>> freeChunks;
+std::mutex freeChunksMutex;
+std::atomic_size_t freeChunkBytes(0);
+/// Only modified while all threads are paused, which is why threads that can be paused may read it without locking.
+GarbageCollectionStatistics statistics;
+/// The file set with @c EMOJICODE_GC_LOG, to which a line of JSON is written for every garbage collection.
+FILE *gcLog = nullptr;
+/// The file set with @c EMOJICODE_HEAP_PROFILE, to which a line of JSON with the live objects of every class is written
+/// after the collection chosen with @c EMOJICODE_HEAP_PROFILE_COLLECTION and after every SIGUSR2.
+FILE *heapProfile = nullptr;
+/// The number of the collection after which a heap profile is written or 0.
+size_t heapProfileCollection = 0;
+/// The path set with @c EMOJICODE_HEAP_SNAPSHOT. A snapshot of all live objects and their references is written to it,
+/// with the number of the collection appended, along with every heap profile.
+const char *heapSnapshotPath = nullptr;
+/// Set by SIGUSR2. The next garbage collection is then a major one and writes a heap profile.
+std::atomic_bool heapProfileRequested(false);
+/// While a heap snapshot is taken, @c mark() appends the references it is passed to this vector instead of marking.
+std::vector<Object *> *snapshotReferences = nullptr;
+/// The file set with @c EMOJICODE_ALLOCATION_PROFILE, to which the sampled allocation sites are written at exit and
+/// along with every heap profile, or @c nullptr if allocations are not sampled.
+const char *allocationProfilePath = nullptr;
+/// An allocation is sampled whenever the allocating thread allocated this many bytes since its last sample.
+size_t allocationSampleInterval;
+/// The number of bytes the calling thread allocated since its last sampled allocation.
+thread_local size_t bytesSinceSample = 0;
+
+/// An instruction that allocated objects of a class. @c offset is the offset of the thread’s execution pointer into
+/// the function, which points into or right after the allocating instruction.
+struct AllocationSite {
+    const Function *function;
+    size_t offset;
+    const Class *klass;
+
+    bool operator<(const AllocationSite &other) const {
+        return std::tie(function, offset, klass) < std::tie(other.function, other.offset, other.klass);
+    }
+};
+
+/// The estimated number of bytes and objects allocated at a site, extrapolated from the samples.
+struct AllocationCounts {
+    size_t samples = 0;
+    size_t bytes = 0;
+    size_t objects = 0;
+};
+
+std::map<AllocationSite, AllocationCounts> allocationSites;
+std::mutex allocationSitesMutex;
+
+/// The times at which the threads paused for the requested garbage collection. Guarded by @c pausingThreadsCountMutex.
+std::vector<std::chrono::steady_clock::time_point> pauseArrivals;
+
+/// The number of bytes used in @c otherOldSpace during a major collection.
+size_t otherOldSpaceUse;
+
+/// Objects larger than this are allocated directly in the old generation instead of the nursery.
+size_t largeObjectSize;
+
+/// The size of the chunks of the nursery that threads allocate in without synchronization.
+size_t allocationBufferSize;
+/// Objects larger than this are allocated in the nursery directly, as they would waste much of an allocation buffer.
+size_t allocationBufferObjectSize;
+
+/// A chunk of the nursery in which one thread allocates by bumping @c next. The unused rest of the chunk is always
+/// covered by a filler object so that the nursery can be walked from object to object.
+struct AllocationBuffer {
+    Byte *next = nullptr;
+    Byte *end = nullptr;
+    /// The value of @c collectionCount when the chunk was handed out. Each garbage collection empties the nursery and
+    /// thereby retires all chunks.
+    size_t collection = 0;
+};
+
+thread_local AllocationBuffer allocationBuffer;
+/// The number of garbage collections run so far. Only modified while all threads are paused.
+size_t collectionCount = 0;
+
+/// The large object space, in which arrays larger than @c largeObjectSize are allocated so that they are never copied.
+/// Each array lies on pages of its own, which are made accessible when it is allocated and returned to the operating
+/// system when sweeping frees it. Only arrays are allocated there as the references in arrays are marked by the
+/// objects owning them, so that minor collections need not scan the large object space.
+Byte *largeObjectSpace;
+/// The size of the address space reserved for the large object space.
+size_t largeObjectSpaceSize;
+/// The number of bytes of the pages the arrays in the large object space lie on.
+std::atomic_size_t largeObjectSpaceUse(0);
+/// A major collection is run before @c largeObjectSpaceUse exceeds this.
+size_t largeObjectSpaceLimit;
+std::mutex largeObjectSpaceMutex;
+/// The arrays in the large object space.
+std::vector<Object *> largeObjects;
+/// The unused pages below @c largeObjectSpaceTop as pairs of the index of the first page and the number of pages.
+std::vector<std::pair<size_t, size_t>> largeObjectFreePages;
+/// The index of the page above which no page of the large object space was used yet.
+size_t largeObjectSpaceTop = 0;
+/// The array lying on each page of the large object space, which lets interior pointers be resolved.
+Object **largeObjectPages;
+/// The mark bits of the arrays in the large object space, stored for their first page.
+std::atomic<Byte> *largeObjectMarks;
+/// Set by major collections.
+const Byte kMajorMark = 1;
+/// Set by the incremental marking and for arrays allocated while it is in progress.
+const Byte kIncrementalMark = 2;
+
+/// The objects a thread registered for deinitialization since the last garbage collection. Every thread appends to
+/// a list of its own so that registering needs no synchronization. The lists of threads that ended are reused.
+struct DeinitializationList {
+    std::vector<Object *> objects;
+    bool inUse = true;
+    DeinitializationList *next;
+};
+
+/// All lists ever handed to a thread, linked by @c DeinitializationList::next.
+DeinitializationList *deinitializationLists = nullptr;
+/// Guards @c deinitializationLists and @c DeinitializationList::inUse.
+std::mutex deinitializationListsMutex;
+/// The registered objects that survived a garbage collection. Only accessed while threads are paused.
+std::vector<Object *> survivingDeinitializationList;
+
+/// Hands the calling thread a deinitialization list on its first registration and returns it once the thread ends.
+class DeinitializationListOwner {
+public:
+    DeinitializationList* list() {
+        if (list_ == nullptr) {
+            std::lock_guard<std::mutex> lock(deinitializationListsMutex);
+            for (auto list = deinitializationLists; list != nullptr && list_ == nullptr; list = list->next) {
+                if (!list->inUse) {
+                    list->inUse = true;
+                    list_ = list;
+                }
+            }
+            if (list_ == nullptr) {
+                list_ = new DeinitializationList();
+                list_->next = deinitializationLists;
+                deinitializationLists = list_;
+            }
+        }
+        return list_;
+    }
+
+    ~DeinitializationListOwner() {
+        if (list_ != nullptr) {
+            std::lock_guard<std::mutex> lock(deinitializationListsMutex);
+            list_->inUse = false;
+        }
+    }
+private:
+    DeinitializationList *list_ = nullptr;
+};
+
+thread_local DeinitializationListOwner deinitializationListOwner;
+
+/// Unreachable objects whose deinitializer has yet to be called by the finalizer thread. Deinitializers close files,
+/// free mutexes or detach threads, which must not lengthen the pauses. The objects are roots until then, which keeps
+/// them and the objects they reference alive. Garbage collections hold @c mutex while they run.
+struct FinalizerQueue {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<Object *> objects;
+};
+
+FinalizerQueue *finalizerQueue;
+
+/// The allocation that did not fit and requested a garbage collection.
+enum class Trigger {
+    /// An allocation in the nursery.
+    Nursery,
+    /// An allocation of an object larger than @c largeObjectSize in the old generation.
+    LargeObject,
+    /// An allocation in the large object space, which only major collections free.
+    LargeObjectSpace,
+    /// A heap profile requested with SIGUSR2, which is written after a major collection.
+    HeapProfile,
+};
+
+void gc(std::unique_lock<std::mutex> &garbageCollectionLock, size_t minSpace, Trigger trigger);
+void writeAllocationProfile();
 
 unsigned int pausingThreadsCount = 0;
 std::atomic_bool pauseThreads(false);
@@ -41,243 +305,1914 @@ std::mutex garbageCollectionMutex;
 std::condition_variable pauseThreadsCondition;
 std::condition_variable pausingThreadsCountCondition;
 
-inline Object* allocateObject(size_t size, Object **keep = nullptr, Thread *thread = nullptr) {
-    RetainedObjectPointer rop(nullptr);
-    if (pauseThreads) {
-        if (keep != nullptr) {
-            rop = thread->retain(*keep);
+/// Runs a garbage collection or, if another thread is already about to run one, waits for it to finish.
+/// @param keep Points to an object that is updated to its new location.
+void collectGarbage(size_t minSpace, Trigger trigger, Object **keep, Thread *thread) {
+    RetainedObjectPointer rop(nullptr);
+    if (keep != nullptr) {
+        rop = thread->retain(*keep);
+    }
+    std::unique_lock<std::mutex> lock(garbageCollectionMutex, std::try_to_lock);
+    if (lock.owns_lock()) {  // OK, this thread is now the garbage collector
+        gc(lock, minSpace, trigger);
+    }
+    else {  // This thread also detected it’s time for garbage collection but lost the race...
+        while (!pauseThreads);
+        performPauseForGC();
+    }
+    if (keep != nullptr) {
+        *keep = rop.unretainedPointer();
+        thread->release(1);
+    }
+}
+
+/// Sets the card objects of all cards whose first byte lies within @c object, which lies in @c space.
+inline void placeOnCards(Object **objects, Byte *space, Object *object, size_t size) {
+    size_t offset = reinterpret_cast<Byte *>(object) - space;
+    for (size_t card = (offset + kCardSize - 1) / kCardSize; card * kCardSize < offset + size; card++) {
+        objects[card] = object;
+    }
+}
+
+/// Sets the card objects of all cards whose first byte lies within @c object, which lies in the old generation.
+inline void placeInOldGeneration(Object *object, size_t size) {
+    placeOnCards(cardObjects, oldGeneration, object, size);
+}
+
+/// The size of the chunks of the old generation into which the workers of a collection copy objects. A multiple of
+/// the card size.
+size_t promotionBufferSize;
+/// Objects larger than this are copied into the old generation directly instead of into a promotion buffer.
+size_t promotionBufferObjectSize;
+
+/// The number of threads that take part in a garbage collection, including the collecting thread. It is configured
+/// with the environment variable @c EMOJICODE_GC_THREADS and defaults to the number of hardware threads.
+unsigned int workerCount = 1;
+
+/// Returns the number of bytes of the old generation that promoting a nursery with @c limit used bytes might take.
+/// Promotion buffers are retired with less than a sixteenth unused and each worker leaves one partially used.
+inline size_t promotionSpace(size_t limit) {
+    return limit + limit / 15 + workerCount * promotionBufferSize;
+}
+
+const size_t kNoSpace = SIZE_MAX;
+
+/// Reserves @c size bytes at the end of the old generation provided that @c reserve bytes remain free beyond them.
+/// Unlike adding @c size and undoing it on failure, this never lets @c oldGenerationUse exceed the old generation, so
+/// that concurrent reservations neither fail spuriously nor overlap.
+/// @returns The offset of the reserved bytes or @c kNoSpace.
+inline size_t reserveInOldGeneration(size_t size, size_t reserve) {
+    size_t index = oldGenerationUse.load(std::memory_order_relaxed);
+    do {
+        if (index + size + reserve > oldSpaceSize) {
+            return kNoSpace;
+        }
+    } while (!oldGenerationUse.compare_exchange_weak(index, index + size));
+    return index;
+}
+
+/// The number of grey objects a worker shares at once and that another worker steals at once.
+const size_t kGreyBatchSize = 32;
+
+/// A thread taking part in a garbage collection: the collecting thread or one of the GC threads.
+struct Worker {
+    /// Objects this worker copied whose references have not been marked yet.
+    std::vector<Object *> greyObjects;
+    /// Grey objects this worker shares with the other workers, which steal them from the front.
+    std::deque<Object *> sharedGreyObjects;
+    std::mutex sharedGreyObjectsMutex;
+    /// The size of @c sharedGreyObjects, which can be read without locking.
+    std::atomic_size_t sharedCount{0};
+    /// The promotion buffer, a chunk of the old generation into which this worker copies objects by bumping @c next.
+    Byte *next = nullptr;
+    Byte *end = nullptr;
+    /// The number of bytes this worker copied during the running collection.
+    size_t bytesCopied = 0;
+    /// Set by mark() if the object being scanned references an object pinned in the nursery.
+    bool referencesPinnedObject = false;
+    /// The scanned objects that reference objects pinned in the nursery, see dirtyPinnedObjectReferrers().
+    std::vector<Object *> pinnedObjectReferrers;
+    /// The cards this worker set in the mod union table during the running minor collection.
+    std::vector<size_t> modUnionCards;
+
+    /// Allocates @c size bytes in the old generation for a copy.
+    Object* allocate(size_t size) {
+        if (size <= promotionBufferObjectSize) {
+            size_t free = end - next;
+            if (size != free && size + sizeof(Object) > free && free < promotionBufferSize / 16) {
+                retire();
+                if (takeFreeChunk()) {
+                    free = end - next;
+                }
+                else {
+                    size_t index = reserveInOldGeneration(promotionBufferSize, 0);
+                    if (index != kNoSpace) {
+                        next = oldGeneration + index;
+                        end = next + promotionBufferSize;
+                        free = promotionBufferSize;
+                    }
+                }
+            }
+            // The rest must be able to hold a filler object.
+            if (size == free || size + sizeof(Object) <= free) {
+                auto object = reinterpret_cast<Object *>(next);
+                next += size;
+                placeInOldGeneration(object, size);
+                return object;
+            }
+        }
+
+        size_t index = reserveInOldGeneration(size, 0);
+        if (index == kNoSpace) {
+            error("Terminating program due to too high memory pressure.");
+        }
+        auto object = reinterpret_cast<Object *>(oldGeneration + index);
+        placeInOldGeneration(object, size);
+        return object;
+    }
+
+    /// Adds @c object to the grey objects and shares a batch of them if this worker has plenty.
+    void push(Object *object) {
+        greyObjects.push_back(object);
+        if (greyObjects.size() >= 2 * kGreyBatchSize && sharedCount == 0 && workerCount > 1) {
+            std::lock_guard<std::mutex> lock(sharedGreyObjectsMutex);
+            auto begin = greyObjects.begin();
+            sharedGreyObjects.insert(sharedGreyObjects.end(), begin, begin + kGreyBatchSize);
+            greyObjects.erase(begin, begin + kGreyBatchSize);
+            sharedCount = sharedGreyObjects.size();
+        }
+    }
+
+    /// Makes a chunk freed by sweeping, or its end, the promotion buffer.
+    bool takeFreeChunk() {
+        if (freeChunkBytes == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(freeChunksMutex);
+        if (freeChunks.empty()) {
+            return false;
+        }
+        auto &chunk = freeChunks.back();
+        size_t size = std::min<size_t>(chunk.second - chunk.first, promotionBufferSize);
+        next = chunk.second - size;
+        end = chunk.second;
+        chunk.second = next;
+        if (chunk.first == chunk.second) {
+            freeChunks.pop_back();
+        }
+        else {
+            reinterpret_cast<Object *>(chunk.first)->size = chunk.second - chunk.first;
+        }
+        freeChunkBytes -= size;
+        return true;
+    }
+
+    void scan(Object *object, Class *klass);
+    void drain();
+    bool canSteal();
+    bool steal();
+    bool terminate();
+    void trace();
+    void retire();
+};
+
+/// Created by the first garbage collection, see startWorkers().
+Worker *workers = nullptr;
+/// The worker the calling thread runs as during a garbage collection.
+thread_local Worker *currentWorker;
+
+void configureWorkers();
+
+Object* allocateObject(size_t size, Object **keep = nullptr, Thread *thread = nullptr);
+
+Object* allocateLargeObject(size_t size, Object **keep, Thread *thread) {
+    size_t index = reserveInOldGeneration(size, promotionSpace(nurseryLimit));
+    if (index == kNoSpace) {
+        collectGarbage(size, Trigger::LargeObject, keep, thread);
+        return allocateObject(size, keep, thread);
+    }
+    auto object = reinterpret_cast<Object *>(oldGeneration + index);
+    std::memset(object, 0, size);
+    placeInOldGeneration(object, size);
+    return object;
+}
+
+/// Makes the first @c size bytes of the reserved address space at @c begin accessible.
+void commit(Byte *begin, size_t size) {
+    if (size > 0 && mprotect(begin, size, PROT_READ | PROT_WRITE) != 0) {
+        error("Cannot allocate heap!");
+    }
+}
+
+inline bool inLargeObjectSpace(const void *pointer) {
+    auto byte = static_cast<const Byte *>(pointer);
+    return largeObjectSpace <= byte && byte < largeObjectSpace + largeObjectSpaceSize;
+}
+
+inline size_t largeObjectPage(const void *pointer) {
+    return (static_cast<const Byte *>(pointer) - largeObjectSpace) / pageSize;
+}
+
+/// Takes @c pages unused pages of the large object space, makes them accessible and places an array on them.
+/// @c largeObjectSpaceMutex must be locked.
+/// @returns The array or @c nullptr if there are not enough consecutive unused pages.
+Object* placeLargeObject(size_t pages) {
+    size_t first = largeObjectSpaceTop;
+    auto range = std::find_if(largeObjectFreePages.begin(), largeObjectFreePages.end(),
+                              [pages](const std::pair<size_t, size_t> &range) { return range.second >= pages; });
+    if (range != largeObjectFreePages.end()) {
+        first = range->first;
+        range->first += pages;
+        range->second -= pages;
+        if (range->second == 0) {
+            largeObjectFreePages.erase(range);
+        }
+    }
+    else if ((largeObjectSpaceTop + pages) * pageSize <= largeObjectSpaceSize) {
+        largeObjectSpaceTop += pages;
+    }
+    else {
+        return nullptr;
+    }
+
+    // Pages that were never used or given back with madvise() are zero-filled by the kernel.
+    auto object = reinterpret_cast<Object *>(largeObjectSpace + first * pageSize);
+    commit(reinterpret_cast<Byte *>(object), pages * pageSize);
+    for (size_t page = first; page < first + pages; page++) {
+        largeObjectPages[page] = object;
+    }
+    largeObjectMarks[first] = incrementalPhase == IncrementalPhase::Marking ? kIncrementalMark : 0;
+    largeObjects.emplace_back(object);
+    largeObjectSpaceUse += pages * pageSize;
+    return object;
+}
+
+/// Allocates an array of @c size bytes in the large object space.
+Object* allocateLargeArray(size_t size, Object **keep, Thread *thread) {
+    size_t pages = (size + pageSize - 1) / pageSize;
+    {
+        std::lock_guard<std::mutex> lock(largeObjectSpaceMutex);
+        if (largeObjectSpaceUse + pages * pageSize <= largeObjectSpaceLimit) {
+            if (Object *object = placeLargeObject(pages)) {
+                return object;
+            }
+        }
+    }
+    collectGarbage(pages * pageSize, Trigger::LargeObjectSpace, keep, thread);
+    std::lock_guard<std::mutex> lock(largeObjectSpaceMutex);
+    Object *object = placeLargeObject(pages);
+    if (object == nullptr) {
+        error("Terminating program due to too high memory pressure.");
+    }
+    return object;
+}
+
+/// Frees all arrays in the large object space for which @c isLive returns false and returns their pages to the
+/// operating system.
+template <typename F>
+void sweepLargeObjectSpace(F isLive) {
+    std::lock_guard<std::mutex> lock(largeObjectSpaceMutex);
+    size_t place = 0;
+    for (Object *object : largeObjects) {
+        if (isLive(object)) {
+            largeObjects[place++] = object;
+            continue;
+        }
+        size_t first = largeObjectPage(object);
+        size_t pages = (object->size + pageSize - 1) / pageSize;
+        madvise(object, pages * pageSize, MADV_DONTNEED);
+        mprotect(object, pages * pageSize, PROT_NONE);
+        largeObjectSpaceUse -= pages * pageSize;
+        largeObjectFreePages.emplace_back(first, pages);
+    }
+    largeObjects.resize(place);
+
+    // Adjacent free pages are merged and those at the top are no longer considered used.
+    std::sort(largeObjectFreePages.begin(), largeObjectFreePages.end());
+    place = 0;
+    for (auto &range : largeObjectFreePages) {
+        if (place > 0 && largeObjectFreePages[place - 1].first + largeObjectFreePages[place - 1].second == range.first) {
+            largeObjectFreePages[place - 1].second += range.second;
+        }
+        else {
+            largeObjectFreePages[place++] = range;
+        }
+    }
+    largeObjectFreePages.resize(place);
+    if (place > 0 && largeObjectFreePages.back().first + largeObjectFreePages.back().second == largeObjectSpaceTop) {
+        largeObjectSpaceTop = largeObjectFreePages.back().first;
+        largeObjectFreePages.pop_back();
+    }
+}
+
+/// Returns the array in the large object space that @c b points into or @c nullptr if @c b points to an unused page.
+Object* largeObjectContaining(const Byte *b) {
+    size_t page = largeObjectPage(b);
+    if (page >= largeObjectSpaceTop) {
+        return nullptr;
+    }
+    for (auto &range : largeObjectFreePages) {
+        if (range.first <= page && page < range.first + range.second) {
+            return nullptr;
+        }
+    }
+    Object *object = largeObjectPages[page];
+    return b < reinterpret_cast<const Byte *>(object) + object->size ? object : nullptr;
+}
+
+/// The class of filler objects. It tells them apart from arrays when walking the heap for a profile.
+Class fillerClass(nullptr);
+
+/// Makes the bytes from @c begin to @c end look like an object, which is never marked.
+inline void fill(Byte *begin, Byte *end) {
+    if (begin < end) {
+        auto filler = reinterpret_cast<Object *>(begin);
+        filler->klass = &fillerClass;
+        filler->size = end - begin;
+    }
+}
+
+/// Allocates @c size bytes in the allocation buffer of the calling thread if they fit.
+/// @returns The allocated object or @c nullptr if the buffer is too full.
+inline Object* allocateInBuffer(size_t size) {
+    auto &buffer = allocationBuffer;
+    if (buffer.collection != collectionCount) {
+        return nullptr;
+    }
+    size_t free = buffer.end - buffer.next;
+    // The rest must be able to hold a filler object.
+    if (size != free && size + sizeof(Object) > free) {
+        return nullptr;
+    }
+    auto object = reinterpret_cast<Object *>(buffer.next);
+    buffer.next += size;
+    fill(buffer.next, buffer.end);
+    return object;
+}
+
+Object* allocateObject(size_t size, Object **keep, Thread *thread) {
+    if (size <= allocationBufferObjectSize) {
+        if (Object *object = allocateInBuffer(size)) {
+            return object;
+        }
+    }
+
+    // The slow path: The calling thread must pause for the garbage collector if it is waiting for threads to pause.
+    RetainedObjectPointer rop(nullptr);
+    if (pauseThreads) {
+        if (keep != nullptr) {
+            rop = thread->retain(*keep);
+        }
+        performPauseForGC();
+        if (keep != nullptr) {
+            *keep = rop.unretainedPointer();
+            thread->release(1);
+        }
+    }
+
+    if (heapProfileRequested) {
+        collectGarbage(0, Trigger::HeapProfile, keep, thread);
+    }
+
+    // Pinned objects might leave too little room for the object, in which case it would never fit after collecting.
+    if (size > largeObjectSize || (!pinnedNurseryObjects.empty() && nurseryPinnedEnd + size > nurseryLimit)) {
+        return allocateLargeObject(size, keep, thread);
+    }
+
+    size_t index;
+    if (size <= allocationBufferObjectSize) {
+        if ((index = nurseryUse.fetch_add(allocationBufferSize)) + allocationBufferSize <= nurseryLimit) {
+            // The nursery is not cleared by garbage collections but chunk by chunk as it is handed out, which keeps
+            // this work out of the pauses.
+            std::memset(nursery + index, 0, allocationBufferSize);
+            allocationBuffer.next = nursery + index;
+            allocationBuffer.end = nursery + index + allocationBufferSize;
+            allocationBuffer.collection = collectionCount;
+            return allocateInBuffer(size);
+        }
+        // The nursery is almost full. The object is allocated on its own so that the space is used.
+        nurseryUse -= allocationBufferSize;
+    }
+
+    if ((index = nurseryUse.fetch_add(size)) + size > nurseryLimit) {
+        nurseryUse -= size;
+        collectGarbage(size, Trigger::Nursery, keep, thread);
+        return allocateObject(size, keep, thread);
+    }
+    std::memset(nursery + index, 0, size);
+    return reinterpret_cast<Object *>(nursery + index);
+}
+
+inline bool inOldGeneration(Object *o) {
+    return oldGeneration <= reinterpret_cast<Byte *>(o) && reinterpret_cast<Byte *>(o) < oldGeneration + oldSpaceSize;
+}
+
+inline bool inNursery(Object *o) {
+    return nursery <= reinterpret_cast<Byte *>(o) && reinterpret_cast<Byte *>(o) < nursery + nurserySize;
+}
+
+/// Returns true if @c o lies in the space the running collection evacuates.
+inline bool inFromSpace(Object *o) {
+    auto byte = reinterpret_cast<Byte *>(o);
+    if (majorCollection) {
+        return otherOldSpace <= byte && byte < otherOldSpace + oldSpaceSize;
+    }
+    return inNursery(o);
+}
+
+/// Attributes @c samples sampling intervals worth of allocations of @c size bytes to the instruction the calling
+/// thread executes. Allocations by native functions are attributed to the instruction that called them.
+void recordAllocationSample(const Class *klass, size_t size, size_t samples) {
+    Thread *thread = ThreadsManager::currentThread();
+    if (thread == nullptr || thread->stackEmpty()) {
+        return;
+    }
+    StackFrame *frame = thread->currentStackFrame();
+    if (frame->function->handler != nullptr) {
+        if (StackFrame *caller = thread->callerStackFrame(frame)) {
+            frame = caller;
+        }
+    }
+    size_t offset = frame->executionPointer != nullptr ? frame->executionPointer - frame->function->block.cells : 0;
+
+    std::lock_guard<std::mutex> lock(allocationSitesMutex);
+    auto &counts = allocationSites[AllocationSite{frame->function, offset, klass}];
+    counts.samples += samples;
+    counts.bytes += samples * allocationSampleInterval;
+    counts.objects += std::max<size_t>(1, samples * allocationSampleInterval / size);
+}
+
+/// Samples the allocation of an object of @c size bytes if allocations are profiled and the calling thread allocated
+/// at least @c allocationSampleInterval bytes since its last sample.
+inline void sampleAllocation(const Class *klass, size_t size) {
+    if (allocationProfilePath == nullptr) {
+        return;
+    }
+    bytesSinceSample += size;
+    if (bytesSinceSample >= allocationSampleInterval) {
+        size_t samples = bytesSinceSample / allocationSampleInterval;
+        bytesSinceSample %= allocationSampleInterval;
+        recordAllocationSample(klass, size, samples);
+    }
+}
+
+Object* newObject(Class *klass) {
+    sampleAllocation(klass, klass->size);
+    Object *object = allocateObject(klass->size);
+    object->size = klass->size;
+    object->klass = klass;
+    return object;
+}
+
+size_t sizeCalculationWithOverflowProtection(size_t items, size_t itemSize) {
+    size_t r = items * itemSize;
+    if (r / items != itemSize) {
+        error("Integer overflow while allocating memory. It’s not possible to allocate objects of this size due to "
+              "hardware limitations.");
+    }
+    return r;
+}
+
+Object* newArray(size_t size) {
+    size_t fullSize = alignSize(sizeof(Object) + size);
+    sampleAllocation(CL_ARRAY, fullSize);
+    Object *object = fullSize > largeObjectSize ? allocateLargeArray(fullSize, nullptr, nullptr) :
+                                                  allocateObject(fullSize);
+    object->size = fullSize;
+    object->klass = CL_ARRAY;
+    return object;
+}
+
+Object* newPinnedArray(size_t size) {
+    size_t fullSize = alignSize(sizeof(Object) + size);
+    sampleAllocation(CL_ARRAY, fullSize);
+    Object *object = allocateLargeArray(fullSize, nullptr, nullptr);
+    object->size = fullSize;
+    object->klass = CL_ARRAY;
+    return object;
+}
+
+bool isPinned(Object *object) {
+    return inLargeObjectSpace(object);
+}
+
+/// Extends @c object to @c newSize bytes without moving it if it is the last object in the calling thread’s
+/// allocation buffer or the nursery and enough space follows it. The additional bytes are zeroed.
+/// @returns False if the object cannot be extended.
+bool growInNursery(Object *object, size_t newSize) {
+    auto end = reinterpret_cast<Byte *>(object) + object->size;
+    size_t growth = newSize - object->size;
+    auto &buffer = allocationBuffer;
+    if (buffer.collection == collectionCount && buffer.next == end) {
+        size_t free = buffer.end - buffer.next;
+        if (growth == free || growth + sizeof(Object) <= free) {
+            // The filler object covering the rest of the buffer is overwritten.
+            std::memset(end, 0, growth);
+            buffer.next += growth;
+            fill(buffer.next, buffer.end);
+            return true;
+        }
+    }
+    if (newSize > largeObjectSize || end <= nursery || end > nursery + nurseryLimit) {
+        return false;
+    }
+    // This only succeeds if no other thread allocated in the nursery since the object, even if it filled a buffer.
+    size_t use = end - nursery;
+    if (use + growth <= nurseryLimit && nurseryUse.compare_exchange_strong(use, use + growth)) {
+        std::memset(end, 0, growth);
+        return true;
+    }
+    return false;
+}
+
+/// Extends the array @c array in the large object space to @c newSize bytes without moving it if its last page has
+/// enough room or the pages above it were never handed out. The additional bytes are zero.
+/// @returns False if the array cannot be extended.
+bool growLargeArray(Object *array, size_t newSize) {
+    size_t pages = (array->size + pageSize - 1) / pageSize;
+    size_t newPages = (newSize + pageSize - 1) / pageSize;
+    if (newPages == pages) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(largeObjectSpaceMutex);
+    size_t first = largeObjectPage(array);
+    size_t growth = (newPages - pages) * pageSize;
+    if (first + pages != largeObjectSpaceTop || (first + newPages) * pageSize > largeObjectSpaceSize ||
+        largeObjectSpaceUse + growth > largeObjectSpaceLimit) {
+        return false;
+    }
+    commit(largeObjectSpace + (first + pages) * pageSize, growth);
+    for (size_t page = first + pages; page < first + newPages; page++) {
+        largeObjectPages[page] = array;
+    }
+    largeObjectSpaceTop = first + newPages;
+    largeObjectSpaceUse += growth;
+    return true;
+}
+
+/// Returns @c ptr extended to @c newSize bytes, which is @c ptr itself if it could be extended in place and otherwise a
+/// copy. The additional bytes are zeroed. The caller must update the size of the returned object.
+Object* resizeObject(Object *ptr, size_t newSize, Thread *thread) {
+    if (newSize >= ptr->size && growInNursery(ptr, newSize)) {
+        sampleAllocation(ptr->klass, newSize - ptr->size);
+        return ptr;
+    }
+    sampleAllocation(ptr->klass, newSize);
+    Object *block = allocateObject(newSize, &ptr, thread);
+    std::memcpy(block, ptr, std::min(ptr->size, newSize));
+    return block;
+}
+
+Object* resizeArray(Object *array, size_t size, Thread *thread) {
+    size_t fullSize = alignSize(sizeof(Object) + size);
+    Object *object;
+    if (inLargeObjectSpace(array) && fullSize >= array->size && growLargeArray(array, fullSize)) {
+        sampleAllocation(CL_ARRAY, fullSize - array->size);
+        object = array;
+    }
+    else if (fullSize > largeObjectSize) {
+        sampleAllocation(CL_ARRAY, fullSize);
+        object = allocateLargeArray(fullSize, &array, thread);
+        std::memcpy(object, array, std::min(array->size, fullSize));
+    }
+    else {
+        object = resizeObject(array, fullSize, thread);
+    }
+    object->size = fullSize;
+    return object;
+}
+
+void writeBarrier(Object *object) {
+    recordWrite(object);
+}
+
+void runFinalizers(Thread *thread);
+
+/// Starts the finalizer thread unless it is running. It is only needed once an object was registered for
+/// deinitialization.
+void startFinalizerThread() {
+    static std::once_flag started;
+    std::call_once(started, []{
+        std::thread(runFinalizers, ThreadsManager::allocateThread()).detach();
+    });
+}
+
+void registerForDeinitialization(Object *object) {
+    startFinalizerThread();
+    deinitializationListOwner.list()->objects.push_back(object);
+}
+
+/// The heap is never smaller than this.
+const size_t kMinimumHeapSize = 1024 * 1024;
+/// The size of the heap unless @c EMOJICODE_HEAP_SIZE is set.
+const size_t kDefaultInitialHeapSize = 16 * 1024 * 1024;
+
+inline size_t alignToPage(size_t size) {
+    return size / pageSize * pageSize;
+}
+
+inline size_t nurserySizeFor(size_t heap) {
+    return std::min(alignToPage(heap / 16), maxNurserySize);
+}
+
+inline size_t oldSpaceSizeFor(size_t heap) {
+    return std::min(alignToPage((heap - nurserySizeFor(heap)) / 2), maxOldSpaceSize);
+}
+
+/// Reads a number of bytes, which may be followed by K, M or G, from the environment variable @c name.
+size_t sizeFromEnvironment(const char *name, size_t defaultSize) {
+    const char *value = getenv(name);
+    if (value == nullptr) {
+        return defaultSize;
+    }
+    char *end;
+    auto size = static_cast<size_t>(strtoull(value, &end, 10));
+    switch (*end) {
+        case 'K': case 'k':
+            return size * 1024;
+        case 'M': case 'm':
+            return size * 1024 * 1024;
+        case 'G': case 'g':
+            return size * 1024 * 1024 * 1024;
+        default:
+            return size;
+    }
+}
+
+/// Makes the heap @c size bytes large. The heap never shrinks and it must only be resized while the nursery is empty.
+void resizeHeap(size_t size) {
+    currentHeapSize = size;
+    nurserySize = nurserySizeFor(size);
+    oldSpaceSize = oldSpaceSizeFor(size);
+    commit(nursery, nurserySize);
+    commit(oldGeneration, oldSpaceSize);
+    commit(otherOldSpace, oldSpaceSize);
+
+    largeObjectSize = nurserySize / 4;
+    allocationBufferSize = std::min<size_t>(32 * 1024, nurserySize / 16);
+    allocationBufferObjectSize = allocationBufferSize / 4;
+    promotionBufferSize = std::max<size_t>(std::min<size_t>(32 * 1024, oldSpaceSize / 256) / kCardSize, 1) * kCardSize;
+    promotionBufferObjectSize = promotionBufferSize / 4;
+}
+
+void allocateHeap() {
+    pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    maxHeapSize = std::max(sizeFromEnvironment("EMOJICODE_MAX_HEAP_SIZE", heapSize), kMinimumHeapSize);
+    size_t initialSize = sizeFromEnvironment("EMOJICODE_HEAP_SIZE", std::min<size_t>(kDefaultInitialHeapSize, heapSize));
+    initialSize = std::min(std::max(initialSize, kMinimumHeapSize), maxHeapSize);
+    if (const char *growth = getenv("EMOJICODE_HEAP_GROWTH")) {
+        heapGrowth = std::max<size_t>(strtoul(growth, nullptr, 10), 1);
+    }
+
+    // The whole address space the heap can grow into is reserved at once. Parts of it are only made accessible as
+    // the heap grows.
+    maxNurserySize = alignToPage(maxHeapSize / 16);
+    maxOldSpaceSize = alignToPage((maxHeapSize - maxNurserySize) / 2);
+    largeObjectSpaceSize = alignToPage(maxHeapSize);
+    void *reservation = mmap(nullptr, maxNurserySize + 2 * maxOldSpaceSize + largeObjectSpaceSize, PROT_NONE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reservation == MAP_FAILED) {
+        error("Cannot allocate heap!");
+    }
+    nursery = static_cast<Byte *>(reservation);
+    oldGeneration = nursery + maxNurserySize;
+    otherOldSpace = oldGeneration + maxOldSpaceSize;
+    largeObjectSpace = otherOldSpace + maxOldSpaceSize;
+    largeObjectPages = new Object*[largeObjectSpaceSize / pageSize];
+    largeObjectMarks = new std::atomic<Byte>[largeObjectSpaceSize / pageSize]();
+    configureWorkers();
+    resizeHeap(initialSize);
+    largeObjectSpaceLimit = oldSpaceSize;
+    nurseryLimit = nurserySize;
+    cardTable = static_cast<Byte *>(calloc(maxOldSpaceSize / kCardSize, 1));
+    cardObjects = new Object*[maxOldSpaceSize / kCardSize];
+    if (const char *pause = getenv("EMOJICODE_GC_PAUSE")) {
+        pauseBudget = std::chrono::microseconds(static_cast<int64_t>(strtod(pause, nullptr) * 1000));
+        markBits = static_cast<Byte *>(calloc(maxOldSpaceSize / alignof(Object) / 8 + 1, 1));
+        modUnionTable = static_cast<Byte *>(calloc(maxOldSpaceSize / kCardSize + 1, 1));
+    }
+    if (const char *path = getenv("EMOJICODE_GC_LOG")) {
+        gcLog = fopen(path, "w");
+        if (gcLog == nullptr) {
+            error("Cannot open garbage collection log %s.", path);
+        }
+    }
+    if (const char *path = getenv("EMOJICODE_HEAP_PROFILE")) {
+        heapProfile = fopen(path, "w");
+        if (heapProfile == nullptr) {
+            error("Cannot open heap profile %s.", path);
+        }
+        if (const char *collection = getenv("EMOJICODE_HEAP_PROFILE_COLLECTION")) {
+            heapProfileCollection = strtoul(collection, nullptr, 10);
+        }
+        heapSnapshotPath = getenv("EMOJICODE_HEAP_SNAPSHOT");
+        signal(SIGUSR2, [](int) { heapProfileRequested = true; });
+    }
+    if ((allocationProfilePath = getenv("EMOJICODE_ALLOCATION_PROFILE"))) {
+        allocationSampleInterval = std::max<size_t>(sizeFromEnvironment("EMOJICODE_ALLOCATION_SAMPLE_INTERVAL",
+                                                                        512 * 1024), 1);
+        atexit(writeAllocationProfile);
+    }
+    otherCardObjects = new Object*[maxOldSpaceSize / kCardSize];
+    nurseryCardObjects = new Object*[maxNurserySize / kCardSize];
+    finalizerQueue = new FinalizerQueue();
+}
+
+/// Marks a from-space object whose copy is being made by another worker.
+Object *const kBeingCopied = reinterpret_cast<Object *>(alignof(Object));
+
+/// Returns the copy of @c oldObject, which lies in the from-space, and copies it if no worker did so before.
+inline Object* evacuate(Object *oldObject) {
+    static_assert(sizeof(std::atomic<Object *>) == sizeof(Object *), "The header cannot be updated atomically");
+    auto header = reinterpret_cast<std::atomic<Object *> *>(&oldObject->newLocation);
+    Object *klass = header->load(std::memory_order_acquire);
+    while (true) {
+        if (inOldGeneration(klass)) {
+            return klass;
+        }
+        if (klass == oldObject) {  // The object is pinned.
+            currentWorker->referencesPinnedObject = true;
+            return oldObject;
+        }
+        if (klass == kBeingCopied) {
+            std::this_thread::yield();
+            klass = header->load(std::memory_order_acquire);
+        }
+        else if (header->compare_exchange_weak(klass, kBeingCopied, std::memory_order_acquire)) {
+            break;
+        }
+    }
+
+    size_t size = oldObject->size;
+    Object *newObject = currentWorker->allocate(size);
+    std::memcpy(newObject, oldObject, size);
+    newObject->newLocation = klass;
+    header->store(newObject, std::memory_order_release);
+    currentWorker->bytesCopied += size;
+    currentWorker->push(newObject);
+    return newObject;
+}
+
+inline bool isMarked(Object *object) {
+    size_t offset = reinterpret_cast<Byte *>(object) - oldGeneration;
+    if (offset >= markStart) {
+        return true;
+    }
+    size_t word = offset / alignof(Object);
+    return (markBits[word / 8] & (1 << (word % 8))) != 0;
+}
+
+/// @returns True if @c object, which must lie in the old generation, was found unreachable by the last incremental
+/// marking and the sweep has not freed it yet. Such an object may still reference objects that were freed already.
+bool awaitsSweep(Object *object) {
+    size_t offset = reinterpret_cast<Byte *>(object) - oldGeneration;
+    return incrementalPhase == IncrementalPhase::Sweeping && sweepOffset <= offset && offset < sweepLimit &&
+        !isMarked(object);
+}
+
+/// Marks @c object for the incremental collection if it lies in the old generation and was not marked yet.
+void markInOldGeneration(Object *object) {
+    auto byte = reinterpret_cast<Byte *>(object);
+    if (inLargeObjectSpace(byte)) {
+        largeObjectMarks[largeObjectPage(byte)] |= kIncrementalMark;
+        return;
+    }
+    if (byte < oldGeneration || oldGeneration + markStart <= byte) {
+        return;
+    }
+    size_t word = (byte - oldGeneration) / alignof(Object);
+    if ((markBits[word / 8] & (1 << (word % 8))) == 0) {
+        markBits[word / 8] |= 1 << (word % 8);
+        markStack.push_back(object);
+    }
+}
+
+void mark(Object **oPointer) {
+    if (markingOldGeneration) {
+        markInOldGeneration(*oPointer);
+        return;
+    }
+    if (snapshotReferences != nullptr) {
+        snapshotReferences->push_back(*oPointer);
+        return;
+    }
+    Object *oldObject = *oPointer;
+    if (!inFromSpace(oldObject)) {
+        if (majorCollection) {
+            // Arrays in the large object space are marked in place. Minor collections consider them reachable.
+            if (inLargeObjectSpace(oldObject)) {
+                largeObjectMarks[largeObjectPage(oldObject)].fetch_or(kMajorMark, std::memory_order_relaxed);
+            }
+            // A major collection follows a minor one, which left only pinned objects in the nursery.
+            else if (inNursery(oldObject)) {
+                currentWorker->referencesPinnedObject = true;
+            }
+        }
+        return;
+    }
+    *oPointer = evacuate(oldObject);
+}
+
+/// Determines the card objects of the nursery by walking it unless this was already done during the running collection.
+void indexNursery() {
+    if (nurseryIndexed.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(nurseryIndexMutex);
+    if (nurseryIndexed.load(std::memory_order_relaxed)) {
+        return;
+    }
+    for (Byte *byte = nursery; byte < nursery + nurseryUse;) {
+        auto object = reinterpret_cast<Object *>(byte);
+        placeOnCards(nurseryCardObjects, nursery, object, object->size);
+        byte += object->size;
+    }
+    nurseryIndexed.store(true, std::memory_order_release);
+}
+
+/// Returns the object in @c space that @c b points into.
+/// @param objects The card objects of @c space.
+inline Object* objectContaining(Object **objects, Byte *space, Byte *b) {
+    // The object covering the first byte of the card starts the walk, which therefore ends on the card.
+    auto byte = reinterpret_cast<Byte *>(objects[(b - space) / kCardSize]);
+    while (true) {
+        auto object = reinterpret_cast<Object *>(byte);
+        if (b < byte + object->size) {
+            return object;
+        }
+        byte += object->size;
+    }
+}
+
+/// Returns the object in the space the running collection evacuates that @c b points into or @c nullptr.
+Object* fromSpaceObjectContaining(Byte *b) {
+    Byte *space = majorCollection ? otherOldSpace : nursery;
+    size_t used = majorCollection ? otherOldSpaceUse : nurseryUse.load();
+    if (b < space || space + used <= b) {
+        return nullptr;
+    }
+    if (!majorCollection) {
+        indexNursery();
+    }
+    return objectContaining(majorCollection ? otherCardObjects : nurseryCardObjects, space, b);
+}
+
+void markValueReference(Value **valuePointer) {
+    auto b = reinterpret_cast<Byte *>(*valuePointer);
+    if (inLargeObjectSpace(b)) {
+        Object *object = largeObjectPages[largeObjectPage(b)];
+        mark(&object);
+        return;
+    }
+    if (markingOldGeneration || snapshotReferences != nullptr) {
+        if (oldGeneration <= b && b < oldGeneration + oldGenerationUse) {
+            Object *object = objectContaining(cardObjects, oldGeneration, b);
+            mark(&object);
+        }
+        return;
+    }
+
+    Object *object = fromSpaceObjectContaining(b);
+    if (object == nullptr) {
+        return;
+    }
+    auto offset = b - reinterpret_cast<Byte *>(object);
+    mark(&object);
+    *valuePointer = reinterpret_cast<Value *>(reinterpret_cast<Byte *>(object) + offset);
+}
+
+void markBox(Box *box) {
+    if (box->type.raw == T_OBJECT) {
+        mark(&box->value1.object);
+    }
+    else if ((box->type.raw & REMOTE_MASK) != 0) {
+        // The storage object is scanned on its own, see BoxObjectVariableRecords::storageClass.
+        mark(&box->value1.object);
+    }
+    else {
+        auto bvr = boxObjectVariableRecordTable[box->type.raw];
+        for (size_t i = 0; i < bvr.count; i++) {
+            markByObjectVariableRecord(bvr.records[i], &box->value1, i);
+        }
+    }
+}
+
+/// Marks the objects referenced by @c object, which is an instance of @c klass. The class is passed separately as the
+/// header of a pinned object does not hold it during a collection.
+inline void scanObject(Object *object, Class *klass) {
+    for (size_t i = 0; i < klass->instanceVariableRecordsCount; i++) {
+        auto record = klass->instanceVariableRecords[i];
+        markByObjectVariableRecord(record, object->variableDestination(0), i);
+    }
+
+    if (klass->mark != nullptr) {
+        klass->mark(object);
+    }
+}
+
+inline void scanObject(Object *object) {
+    scanObject(object, object->klass);
+}
+
+/// Scans @c object and remembers it if it references an object pinned in the nursery.
+void Worker::scan(Object *object, Class *klass) {
+    referencesPinnedObject = false;
+    scanObject(object, klass);
+    if (referencesPinnedObject) {
+        pinnedObjectReferrers.push_back(object);
+    }
+}
+
+/// The objects the running collection pinned in the from-space along with their classes, as their headers forward to
+/// themselves while the collection runs.
+std::vector<std::pair<Object *, Class *>> pinnedObjects;
+
+/// Marks the object that @c b, a word on an operand stack, points into without changing the word. A collection that
+/// moves objects pins the object if it lies in the from-space.
+void markOperand(Byte *b) {
+    if (inLargeObjectSpace(b)) {
+        if (Object *object = largeObjectContaining(b)) {
+            mark(&object);
+        }
+        return;
+    }
+    Object *object;
+    if (markingOldGeneration || snapshotReferences != nullptr) {
+        if (b < oldGeneration || oldGeneration + oldGenerationUse <= b) {
+            return;
+        }
+        object = objectContaining(cardObjects, oldGeneration, b);
+    }
+    else {
+        object = fromSpaceObjectContaining(b);
+    }
+    if (object == nullptr || object->klass == &fillerClass) {
+        return;
+    }
+    if (markingOldGeneration || snapshotReferences != nullptr) {
+        mark(&object);
+    }
+    else if (object->newLocation != object) {
+        pinnedObjects.emplace_back(object, object->klass);
+        object->newLocation = object;
+    }
+}
+
+void markThread(Thread *thread) {
+    thread->markStack();
+    thread->markRetainList();
+    // The words on the operand stack are not typed. Marking does not move objects, so that the words can be treated
+    // like value references without being updated. Collections that move objects pin them, see pinOperandReferents().
+    if (markingOldGeneration || snapshotReferences != nullptr) {
+        for (Value *value = thread->rstack_; value < thread->rstackPointer_; value++) {
+            markOperand(reinterpret_cast<Byte *>(value->value));
+        }
+    }
+}
+
+/// The number of string pool entries or cards that form one root task.
+const size_t kStringPoolTaskSize = 256;
+const size_t kCardTaskSize = 64;
+
+/// The threads whose stacks and retain lists are the first root tasks of the running collection.
+std::vector<Thread *> rootThreads;
+/// The number of bytes of the old generation whose dirty cards are scanned by the running collection.
+size_t rootCardLimit;
+std::atomic_size_t nextRootTask;
+
+/// Scans the objects of the old generation that lie on dirty cards from card @c first to card @c last, exclusive, but
+/// not beyond @c limit bytes. These are the only objects in the old generation that can reference objects in the
+/// nursery.
+void scanDirtyCards(size_t first, size_t last, size_t limit) {
+    for (size_t card = first; card < last && card * kCardSize < limit; card++) {
+        if (cardTable[card] == 0) {
+            continue;
         }
-        performPauseForGC();
-        if (keep != nullptr) {
-            *keep = rop.unretainedPointer();
-            thread->release(1);
+        if (incrementalPhase == IncrementalPhase::Marking && modUnionTable[card] == 0) {
+            modUnionTable[card] = 1;
+            currentWorker->modUnionCards.push_back(card);
+        }
+        Byte *end = oldGeneration + std::min((card + 1) * kCardSize, limit);
+        for (auto byte = reinterpret_cast<Byte *>(cardObjects[card]); byte < end;) {
+            auto object = reinterpret_cast<Object *>(byte);
+            if (!awaitsSweep(object)) {
+                currentWorker->scan(object, object->klass);
+            }
+            byte += object->size;
         }
     }
+}
 
-    size_t index;
-    if ((index = memoryUse.fetch_add(size)) + size > gcThreshold) {
-        memoryUse -= size;
-        if (keep != nullptr) {
-            rop = thread->retain(*keep);
-        }
-        std::unique_lock<std::mutex> lock(garbageCollectionMutex, std::try_to_lock);
-        if (lock.owns_lock()) {  // OK, this thread is now the garbage collector
-            gc(lock, size);
+/// Claims and runs root tasks until there are none left. The roots are the thread stacks and retain lists, the
+/// string pool and, in a minor collection, the dirty cards.
+void markRootTasks() {
+    size_t threadTasks = rootThreads.size();
+    size_t stringPoolTasks = (stringPoolCount + kStringPoolTaskSize - 1) / kStringPoolTaskSize;
+    size_t cardTasks = (rootCardLimit + kCardSize * kCardTaskSize - 1) / (kCardSize * kCardTaskSize);
+    size_t task;
+    while ((task = nextRootTask++) < threadTasks + stringPoolTasks + cardTasks) {
+        if (task < threadTasks) {
+            markThread(rootThreads[task]);
         }
-        else {  // This thread also detected it’s time for garbage collection but lost the race...
-            while (!pauseThreads);
-            performPauseForGC();
+        else if ((task -= threadTasks) < stringPoolTasks) {
+            size_t end = std::min<size_t>((task + 1) * kStringPoolTaskSize, stringPoolCount);
+            for (size_t i = task * kStringPoolTaskSize; i < end; i++) {
+                mark(stringPool + i);
+            }
         }
-        if (keep != nullptr) {
-            *keep = rop.unretainedPointer();
-            thread->release(1);
+        else {
+            task -= stringPoolTasks;
+            scanDirtyCards(task * kCardTaskSize, (task + 1) * kCardTaskSize, rootCardLimit);
         }
-        return allocateObject(size);
     }
-    return reinterpret_cast<Object *>(currentHeap + index);
 }
 
-inline bool inCurrentHeap(Object *o) {
-    return currentHeap <= reinterpret_cast<Byte *>(o) && reinterpret_cast<Byte *>(o) < currentHeap + heapSize / 2;
-}
+/// The number of workers that have not run out of work in the running collection.
+std::atomic_uint busyWorkers;
 
-Object* resizeObject(Object *ptr, size_t newSize, Thread *thread) {
-//    auto expectation = reinterpret_cast<size_t>(ptr) - reinterpret_cast<size_t>(currentHeap);
-//    size_t index = memoryUse;
-//    if (index + newSize <= gcThreshold && memoryUse.compare_exchange_weak(expectation, index + newSize)) {
-//        // memoryUse equaled the expectation, therefore no allocation has happend in the meantime, index still
-//        // represented the value of memory use and it was leigtimate to replace memoryUse’s value with index + newSize
-//        return ptr;
-//    }
+/// Returns true if another worker shares grey objects.
+bool Worker::canSteal() {
+    for (unsigned int i = 0; i < workerCount; i++) {
+        if (workers[i].sharedCount > 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    Object *block = allocateObject(newSize, &ptr, thread);
-    std::memcpy(block, ptr, ptr->size);
-    return block;
+/// Takes a batch of grey objects from the shared objects of another worker.
+bool Worker::steal() {
+    for (unsigned int i = 0; i < workerCount; i++) {
+        Worker &victim = workers[(this - workers + i) % workerCount];
+        if (victim.sharedCount == 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(victim.sharedGreyObjectsMutex);
+        size_t count = std::min(victim.sharedGreyObjects.size(), kGreyBatchSize);
+        auto begin = victim.sharedGreyObjects.begin();
+        greyObjects.insert(greyObjects.end(), begin, begin + count);
+        victim.sharedGreyObjects.erase(begin, begin + count);
+        victim.sharedCount = victim.sharedGreyObjects.size();
+        if (count > 0) {
+            return true;
+        }
+    }
+    return false;
 }
 
-Object* newObject(Class *klass) {
-    Object *object = allocateObject(klass->size);
-    object->size = klass->size;
-    object->klass = klass;
-    return object;
+/// Waits until all workers ran out of work or until another worker shares grey objects.
+/// @returns True if all workers ran out of work, which completes the collection.
+bool Worker::terminate() {
+    busyWorkers--;
+    while (true) {
+        if (busyWorkers == 0) {
+            return true;
+        }
+        if (canSteal()) {
+            busyWorkers++;
+            return false;
+        }
+        std::this_thread::yield();
+    }
 }
 
-size_t sizeCalculationWithOverflowProtection(size_t items, size_t itemSize) {
-    size_t r = items * itemSize;
-    if (r / items != itemSize) {
-        error("Integer overflow while allocating memory. It’s not possible to allocate objects of this size due to "
-              "hardware limitations.");
+/// Scans grey objects until no worker has any left to share.
+void Worker::drain() {
+    while (!greyObjects.empty() || steal()) {
+        Object *object = greyObjects.back();
+        greyObjects.pop_back();
+        scan(object, object->klass);
     }
-    return r;
 }
 
-Object* newArray(size_t size) {
-    size_t fullSize = alignSize(sizeof(Object) + size);
-    Object *object = allocateObject(fullSize);
-    object->size = fullSize;
-    object->klass = CL_ARRAY;
-    return object;
+/// Runs this worker’s share of the running collection.
+void Worker::trace() {
+    currentWorker = this;
+    markRootTasks();
+    do {
+        drain();
+    } while (!terminate());
 }
 
-Object* resizeArray(Object *array, size_t size, Thread *thread) {
-    size_t fullSize = alignSize(sizeof(Object) + size);
-    Object *object = resizeObject(array, fullSize, thread);
-    object->size = fullSize;
-    return object;
+/// Fills the unused rest of the promotion buffer, which leaves the old generation walkable.
+void Worker::retire() {
+    if (next < end) {
+        fill(next, end);
+        placeInOldGeneration(reinterpret_cast<Object *>(next), end - next);
+    }
+    next = end = nullptr;
 }
 
-void registerForDeinitialization(Object *object) {
-    if (deinitializationListSize == deinitializationListIndex) {
-        std::lock_guard<std::mutex> lock(deinitializationListResizeMutex);
-        if (deinitializationListSize == deinitializationListIndex) {
-            auto newList = new Object*[deinitializationListSize * 2];
-            std::memcpy(newList, deinitializationList, sizeof(Object*) * deinitializationListIndex);
-            deinitializationList = newList;
-            deinitializationListSize = deinitializationListSize * 2;
+/// Synchronizes the GC threads with the collecting thread. It is never destroyed, as destroying a condition variable
+/// on which the GC threads wait blocks the exit of the program.
+struct WorkerPool {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::condition_variable finishedCondition;
+    /// Incremented to let the GC threads take part in the next collection.
+    size_t round = 0;
+    unsigned int finished = 0;
+};
+
+WorkerPool *workerPool;
+
+void runGCThread(Worker *worker) {
+    size_t round = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(workerPool->mutex);
+            workerPool->condition.wait(lock, [round]{ return workerPool->round != round; });
+            round = workerPool->round;
+        }
+        worker->trace();
+        {
+            std::lock_guard<std::mutex> lock(workerPool->mutex);
+            workerPool->finished++;
         }
+        workerPool->finishedCondition.notify_one();
     }
-    deinitializationList[deinitializationListIndex++] = object;
 }
 
-void allocateHeap() {
-    currentHeap = static_cast<Byte *>(calloc(heapSize, 1));
-    if (currentHeap == nullptr) {
-        error("Cannot allocate heap!");
-    }
-    otherHeap = currentHeap + (heapSize / 2);
-    deinitializationList = new Object*[7];
+void configureWorkers() {
+    const char *threads = getenv("EMOJICODE_GC_THREADS");
+    workerCount = threads != nullptr ? static_cast<unsigned int>(strtoul(threads, nullptr, 10))
+                                     : std::thread::hardware_concurrency();
+    workerCount = std::max(workerCount, 1u);
 }
 
-void mark(Object **oPointer) {
-    Object *oldObject = *oPointer;
-    if (inCurrentHeap(oldObject->newLocation)) {
-        *oPointer = oldObject->newLocation;
+/// Creates the workers and starts the GC threads if no collection did so before. Programs that never collect garbage
+/// thereby do not start any threads.
+void startWorkers() {
+    if (workers != nullptr) {
         return;
     }
+    workers = new Worker[workerCount];
+    workerPool = new WorkerPool();
+    for (unsigned int i = 1; i < workerCount; i++) {
+        std::thread(runGCThread, workers + i).detach();
+    }
+}
 
-    auto *newObject = reinterpret_cast<Object *>(currentHeap + memoryUse);
-    memoryUse += oldObject->size;
+/// Copies all objects reachable from the roots with all workers. @c rootCardLimit must have been set.
+void traceInParallel() {
+    rootThreads.clear();
+    for (Thread *thread = ThreadsManager::anyThread(); thread != nullptr; thread = ThreadsManager::nextThread(thread)) {
+        rootThreads.push_back(thread);
+    }
+    nextRootTask = 0;
+    busyWorkers = workerCount;
 
-    std::memcpy(newObject, oldObject, oldObject->size);
+    if (workerCount > 1) {
+        {
+            std::lock_guard<std::mutex> lock(workerPool->mutex);
+            workerPool->finished = 0;
+            workerPool->round++;
+        }
+        workerPool->condition.notify_all();
+    }
+    workers[0].trace();
+    if (workerCount > 1) {
+        std::unique_lock<std::mutex> lock(workerPool->mutex);
+        workerPool->finishedCondition.wait(lock, []{ return workerPool->finished == workerCount - 1; });
+    }
 
-    oldObject->newLocation = newObject;
-    *oPointer = newObject;
+    for (unsigned int i = 0; i < workerCount; i++) {
+        workers[i].retire();
+        statistics.bytesCopied += workers[i].bytesCopied;
+        workers[i].bytesCopied = 0;
+        modUnionCards.insert(modUnionCards.end(), workers[i].modUnionCards.begin(), workers[i].modUnionCards.end());
+        workers[i].modUnionCards.clear();
+    }
 }
 
-inline bool inOldHeap(Value *o) {
-    return otherHeap <= reinterpret_cast<Byte *>(o) && reinterpret_cast<Byte *>(o) < otherHeap + heapSize / 2;
+/// Hands the unreachable @c object to the finalizer thread, which calls its deinitializer once the threads resumed.
+void finalize(Object *object) {
+    finalizerQueue->objects.push_back(object);
+    statistics.objectsDeinitialized++;
 }
 
-void markValueReference(Value **valuePointer) {
-    if (!inOldHeap(*valuePointer)) {
-        return;
-    }
-    auto b = reinterpret_cast<Byte *>(*valuePointer);
-
-    Byte *byte = otherHeap;
+/// Calls the deinitializers of the objects in the finalizer queue on the finalizer thread. It takes part in the pauses
+/// like any other thread, so that no collection moves an object while its deinitializer runs.
+void runFinalizers(Thread *thread) {
+    ThreadsManager::enterThread(thread);
     while (true) {
-        auto object = reinterpret_cast<Object *>(byte);
-        if (b < byte + object->size) {
-            auto offset = b - byte;
-            mark(&object);
-            *valuePointer = reinterpret_cast<Value *>(reinterpret_cast<Byte *>(object) + offset);
-            return;
+        allowGC();
+        {
+            std::unique_lock<std::mutex> lock(finalizerQueue->mutex);
+            finalizerQueue->condition.wait(lock, []{ return !finalizerQueue->objects.empty(); });
+        }
+        disallowGCAndPauseIfNeeded();
+        while (true) {
+            Object *object;
+            {
+                std::lock_guard<std::mutex> lock(finalizerQueue->mutex);
+                if (finalizerQueue->objects.empty()) {
+                    break;
+                }
+                object = finalizerQueue->objects.back();
+                finalizerQueue->objects.pop_back();
+            }
+            object->klass->deinit(object);
+            pauseForGC();
         }
-        byte += object->size;
     }
 }
 
-void markBox(Box *box) {
-    if (box->type.raw == T_OBJECT) {
-        mark(&box->value1.object);
+/// Copies the objects the running collection handed to the finalizer queue, from index @c first on, and all objects
+/// they reference, which the collection found unreachable as well.
+void keepFinalizedObjects(size_t first) {
+    currentWorker = workers;
+    for (size_t i = first; i < finalizerQueue->objects.size(); i++) {
+        mark(&finalizerQueue->objects[i]);
     }
-    else if ((box->type.raw & REMOTE_MASK) != 0) {
-        mark(&box->value1.object);
-        auto bvr = boxObjectVariableRecordTable[(box->type.raw & ~REMOTE_MASK)];
-        for (size_t i = 0; i < bvr.count; i++) {
-            markByObjectVariableRecord(bvr.records[i], box->value1.object->val<Value>(), i);
+    workers[0].drain();
+    workers[0].retire();
+    statistics.bytesCopied += workers[0].bytesCopied;
+    workers[0].bytesCopied = 0;
+}
+
+/// Returns the location of the registered @c object after the running collection or @c nullptr if @c object was
+/// unreachable and has been finalized.
+Object* survivorOrFinalize(Object *object) {
+    if (!inFromSpace(object) || object->newLocation == object) {  // The object was not collected or is pinned.
+        return object;
+    }
+    if (inOldGeneration(object->newLocation)) {
+        return object->newLocation;
+    }
+    finalize(object);
+    return nullptr;
+}
+
+/// Finalizes all registered objects in the from-space that were not copied and copies them for the finalizer thread.
+/// Collecting the nursery only checks the objects registered since the last collection and moves the survivors to
+/// @c survivingDeinitializationList, except for those pinned in the nursery, which are checked again by the next
+/// collection.
+void deinitializeUnreachableObjects() {
+    size_t first = finalizerQueue->objects.size();
+    if (majorCollection) {
+        size_t place = 0;
+        for (auto object : survivingDeinitializationList) {
+            if (Object *survivor = survivorOrFinalize(object)) {
+                survivingDeinitializationList[place++] = survivor;
+            }
         }
+        survivingDeinitializationList.resize(place);
     }
     else {
-        auto bvr = boxObjectVariableRecordTable[box->type.raw];
-        for (size_t i = 0; i < bvr.count; i++) {
-            markByObjectVariableRecord(bvr.records[i], &box->value1, i);
+        std::lock_guard<std::mutex> lock(deinitializationListsMutex);
+        for (auto list = deinitializationLists; list != nullptr; list = list->next) {
+            size_t place = 0;
+            for (auto object : list->objects) {
+                if (Object *survivor = survivorOrFinalize(object)) {
+                    if (inNursery(survivor)) {
+                        list->objects[place++] = survivor;
+                    }
+                    else {
+                        survivingDeinitializationList.push_back(survivor);
+                    }
+                }
+            }
+            list->objects.resize(place);
         }
     }
+    keepFinalizedObjects(first);
 }
 
-void gc(std::unique_lock<std::mutex> &garbageCollectionLock, size_t minSpace) {
-    pauseThreads = true;
-    if (minSpace > gcThreshold) {
-        error("Allocation of %zu bytes is too big. Try to enlarge the heap. (Heap size: %zu)", minSpace, heapSize);
+/// Pins the objects in the from-space that the words on the operand stacks point into and scans all pinned objects,
+/// which are roots of the running collection.
+///
+/// The words on the operand stacks are not typed. A word that looks like a pointer into an object might as well be an
+/// integer or a double, which must not be changed. Such objects are therefore not moved, but pinned: their headers
+/// forward to themselves and they are left in place. This keeps them alive even if the word was no reference, which
+/// is why the sweep of an incremental collection must be complete, as the objects referenced by an unreachable object
+/// might have been freed otherwise.
+void pinOperandReferents() {
+    currentWorker = workers;
+    for (Thread *thread = ThreadsManager::anyThread(); thread != nullptr; thread = ThreadsManager::nextThread(thread)) {
+        for (Value *value = thread->rstack_; value < thread->rstackPointer_; value++) {
+            markOperand(reinterpret_cast<Byte *>(value->value));
+        }
     }
+    for (auto &pinned : pinnedObjects) {
+        currentWorker->scan(pinned.first, pinned.second);
+    }
+    for (Object *object : pinnedOldObjects) {
+        currentWorker->scan(object, object->klass);
+    }
+    if (majorCollection) {
+        for (Object *object : pinnedNurseryObjects) {
+            currentWorker->scan(object, object->klass);
+        }
+    }
+}
 
-    auto pausingThreadsCountLock = std::unique_lock<std::mutex>(pausingThreadsCountMutex);
-    pausingThreadsCount++;
+/// Restores the headers of the objects pinned by the running collection and remembers the objects for the following
+/// collections.
+void unpinObjects() {
+    for (auto &pinned : pinnedObjects) {
+        pinned.first->klass = pinned.second;
+    }
+    std::vector<Object *> &objects = majorCollection ? pinnedOldObjects : pinnedNurseryObjects;
+    objects.clear();
+    for (auto &pinned : pinnedObjects) {
+        objects.push_back(pinned.first);
+    }
+    pinnedObjects.clear();
+    std::sort(objects.begin(), objects.end());
+}
 
-    pausingThreadsCountCondition.wait(pausingThreadsCountLock, []{
-        return pausingThreadsCount == ThreadsManager::threadsCount();
-    });
+/// Dirties the cards of the objects in the old generation that reference objects pinned in the nursery, so that the
+/// next minor collection updates the references if it moves the objects.
+void dirtyPinnedObjectReferrers() {
+    for (unsigned int i = 0; i < workerCount; i++) {
+        for (Object *object : workers[i].pinnedObjectReferrers) {
+            recordWrite(object);
+        }
+        workers[i].pinnedObjectReferrers.clear();
+    }
+}
 
-    std::swap(currentHeap, otherHeap);
+/// Promotes all reachable objects in the nursery to the old generation and empties the nursery but for the objects it
+/// pins. The bytes between them are covered by filler objects.
+void collectNursery() {
+    size_t promotionStart = oldGenerationUse;
 
-    size_t oldMemoryUse = memoryUse;
-    memoryUse = 0;
+    rootCardLimit = promotionStart;
+    nurseryIndexed = false;
+    pinOperandReferents();
+    traceInParallel();
 
-    std::lock_guard<std::mutex> threadListLock(ThreadsManager::threadListMutex);
-    for (Thread *thread = ThreadsManager::anyThread(); thread != nullptr; thread = ThreadsManager::nextThread(thread)) {
-        thread->markStack();
-        thread->markRetainList();
+    deinitializeUnreachableObjects();
+    unpinObjects();
+
+    Byte *begin = nursery;
+    for (Object *object : pinnedNurseryObjects) {
+        fill(begin, reinterpret_cast<Byte *>(object));
+        begin = reinterpret_cast<Byte *>(object) + object->size;
+    }
+    nurseryPinnedEnd = begin - nursery;
+    nurseryUse = nurseryPinnedEnd;
+    collectionCount++;
+    std::memset(cardTable, 0, (promotionStart + kCardSize - 1) / kCardSize);
+    dirtyPinnedObjectReferrers();
+}
+
+/// Limits the work done by the incremental collection during one pause.
+class PauseBudget {
+public:
+    explicit PauseBudget(std::chrono::steady_clock::time_point deadline) : deadline_(deadline) {}
+    /// Returns true if the pause must end. Some work is always done so that the collection progresses.
+    bool exhausted() {
+        return ++work_ % 128 == 0 && work_ > 1024 && std::chrono::steady_clock::now() >= deadline_;
+    }
+private:
+    std::chrono::steady_clock::time_point deadline_;
+    size_t work_ = 0;
+};
+
+bool sweep(PauseBudget *budget);
+
+/// Places the objects the last major collection pinned at the start of the old generation, into which they were
+/// swapped, and covers the bytes between them with filler objects. Objects are copied behind them.
+void keepPinnedOldObjects() {
+    Byte *begin = oldGeneration;
+    for (Object *object : pinnedOldObjects) {
+        fill(begin, reinterpret_cast<Byte *>(object));
+        placeInOldGeneration(reinterpret_cast<Object *>(begin), reinterpret_cast<Byte *>(object) - begin);
+        placeInOldGeneration(object, object->size);
+        begin = reinterpret_cast<Byte *>(object) + object->size;
+    }
+    oldGenerationUse = begin - oldGeneration;
+}
+
+/// Copies all reachable objects of the old generation into the other semispace. The nursery must be empty but for
+/// pinned objects.
+void collectOldGeneration() {
+    // Objects pinned in the from-space are scanned, and an unswept unreachable object might reference freed memory.
+    if (incrementalPhase == IncrementalPhase::Sweeping) {
+        PauseBudget unlimited(std::chrono::steady_clock::time_point::max());
+        sweep(&unlimited);
     }
+    // The copy supersedes any incremental collection in progress and its free chunks lie in the from-space.
+    incrementalPhase = IncrementalPhase::Idle;
+    markStack.clear();
+    freeChunks.clear();
+    freeChunkBytes = 0;
+
+    std::swap(oldGeneration, otherOldSpace);
+    std::swap(cardObjects, otherCardObjects);
+    otherOldSpaceUse = oldGenerationUse;
+    majorCollection = true;
+    keepPinnedOldObjects();
+
+    rootCardLimit = 0;
+    pinOperandReferents();
+    for (auto &object : finalizerQueue->objects) {
+        mark(&object);
+    }
+    traceInParallel();
+
+    deinitializeUnreachableObjects();
+    unpinObjects();
+    sweepLargeObjectSpace([](Object *object) {
+        return (largeObjectMarks[largeObjectPage(object)].exchange(0) & kMajorMark) != 0;
+    });
+    majorCollection = false;
+    dirtyPinnedObjectReferrers();
+}
 
+/// Marks the objects in the old generation referenced by the roots, which include the pinned objects.
+void markRootsInOldGeneration() {
+    for (Thread *thread = ThreadsManager::anyThread(); thread != nullptr; thread = ThreadsManager::nextThread(thread)) {
+        markThread(thread);
+    }
     for (uint_fast16_t i = 0; i < stringPoolCount; i++) {
         mark(stringPool + i);
     }
+    for (auto objects : {&pinnedNurseryObjects, &pinnedOldObjects}) {
+        for (Object *object : *objects) {
+            scanObject(object);
+        }
+    }
+    for (auto &object : finalizerQueue->objects) {
+        mark(&object);
+    }
+}
 
-    for (Byte *byte = currentHeap; byte < currentHeap + memoryUse;) {
-        auto object = reinterpret_cast<Object *>(byte);
+/// Marks the references of marked objects until the mark stack is empty or the budget is exhausted.
+/// @returns True if the mark stack is empty.
+bool drainMarkStack(PauseBudget *budget) {
+    while (!markStack.empty()) {
+        if (budget != nullptr && budget->exhausted()) {
+            return false;
+        }
+        Object *object = markStack.back();
+        markStack.pop_back();
+        scanObject(object);
+    }
+    return true;
+}
 
-        for (size_t i = 0; i < object->klass->instanceVariableRecordsCount; i++) {
-            auto record = object->klass->instanceVariableRecords[i];
-            markByObjectVariableRecord(record, object->variableDestination(0), i);
+/// Scans the objects that were promoted or allocated in the old generation since the marking began. Their references
+/// were copied without passing a write barrier.
+/// @returns True if all such objects were scanned before the budget was exhausted.
+bool scanNewObjects(PauseBudget *budget) {
+    while (scannedOffset < oldGenerationUse) {
+        if (budget != nullptr && budget->exhausted()) {
+            return false;
         }
+        auto object = reinterpret_cast<Object *>(oldGeneration + scannedOffset);
+        scanObject(object);
+        scannedOffset += object->size;
+    }
+    return true;
+}
 
-        if (object->klass->mark != nullptr) {
-            object->klass->mark(object);
+/// Rescans the marked objects on the cards of the mod union table, as references might have been stored into them
+/// after they were scanned.
+/// @returns True if all cards were rescanned before the budget was exhausted.
+bool rescanModUnionCards(PauseBudget *budget) {
+    size_t limit = oldGenerationUse;
+    while (!modUnionCards.empty()) {
+        if (budget != nullptr && budget->exhausted()) {
+            return false;
+        }
+        size_t card = modUnionCards.back();
+        modUnionCards.pop_back();
+        modUnionTable[card] = 0;
+        Byte *end = oldGeneration + std::min((card + 1) * kCardSize, limit);
+        for (auto byte = reinterpret_cast<Byte *>(cardObjects[card]); byte < end;) {
+            auto object = reinterpret_cast<Object *>(byte);
+            if (isMarked(object)) {
+                scanObject(object);
+            }
+            byte += object->size;
         }
-        byte += object->size;
     }
+    return true;
+}
 
-    if (oldMemoryUse == memoryUse) {
-        error("Terminating program due to too high memory pressure.");
+/// Finalizes all registered objects in the old generation that were not marked. The nursery must be empty but for
+/// pinned objects.
+void deinitializeUnmarkedObjects() {
+    size_t place = 0;
+    for (auto object : survivingDeinitializationList) {
+        if (!inOldGeneration(object) || isMarked(object)) {
+            survivingDeinitializationList[place++] = object;
+        }
+        else {
+            finalize(object);
+            markInOldGeneration(object);
+        }
     }
+    survivingDeinitializationList.resize(place);
+    // The objects are swept only once their deinitializers ran, and neither are the objects they reference.
+    drainMarkStack(nullptr);
+}
 
-//    std::memset(otherHeap, 0xAA, heapSize / 2);
+/// Turns the unreachable bytes from @c begin to @c end into filler objects and adds the whole cards among them to the
+/// free chunks.
+void freeInOldGeneration(Byte *begin, Byte *end) {
+    auto chunkBegin = oldGeneration + (begin - oldGeneration + kCardSize - 1) / kCardSize * kCardSize;
+    auto chunkEnd = oldGeneration + (end - oldGeneration) / kCardSize * kCardSize;
+    // The rests before and after the chunk must be able to hold a filler object.
+    if (chunkBegin != begin && static_cast<size_t>(chunkBegin - begin) < sizeof(Object)) {
+        chunkBegin += kCardSize;
+    }
+    if (chunkEnd != end && static_cast<size_t>(end - chunkEnd) < sizeof(Object)) {
+        chunkEnd -= kCardSize;
+    }
+    if (chunkBegin >= chunkEnd) {
+        chunkBegin = chunkEnd = end;
+    }
 
-    if (zeroingNeeded) {
-        std::memset(currentHeap + memoryUse, 0, (heapSize / 2) - memoryUse);
+    for (auto range : {std::make_pair(begin, chunkBegin), std::make_pair(chunkBegin, chunkEnd),
+                       std::make_pair(chunkEnd, end)}) {
+        if (range.first < range.second) {
+            fill(range.first, range.second);
+            placeInOldGeneration(reinterpret_cast<Object *>(range.first), range.second - range.first);
+        }
     }
-    else {
-        zeroingNeeded = true;
+    if (chunkBegin < chunkEnd) {
+        freeChunks.emplace_back(chunkBegin, chunkEnd);
+        freeChunkBytes += chunkEnd - chunkBegin;
     }
+}
 
-    size_t place = 0;
-    for (size_t i = 0; i < deinitializationListIndex; i++) {
-        if (inCurrentHeap(deinitializationList[i]->newLocation)) {
-            deinitializationList[place++] = deinitializationList[i]->newLocation;
+/// Frees the unmarked objects below @c sweepLimit until the budget is exhausted.
+/// @returns True if the sweep is complete.
+bool sweep(PauseBudget *budget) {
+    Byte *end = oldGeneration + sweepLimit;
+    Byte *byte = oldGeneration + sweepOffset;
+    while (byte < end) {
+        if (budget->exhausted()) {
+            sweepOffset = byte - oldGeneration;
+            return false;
+        }
+        if (isMarked(reinterpret_cast<Object *>(byte))) {
+            byte += reinterpret_cast<Object *>(byte)->size;
+            continue;
+        }
+        Byte *deadEnd = byte;
+        while (deadEnd < end && !isMarked(reinterpret_cast<Object *>(deadEnd))) {
+            deadEnd += reinterpret_cast<Object *>(deadEnd)->size;
+        }
+        freeInOldGeneration(byte, deadEnd);
+        byte = deadEnd;
+    }
+    return true;
+}
+
+/// Advances the incremental collection of the old generation until @c budget is exhausted. The nursery must be empty.
+/// Minor collections in between record the dirty cards in the mod union table, which the remark scans again. After
+/// @c kMaxRemarkAttempts pauses the remark completes regardless of the budget.
+void collectIncrementally(PauseBudget *budget) {
+    markingOldGeneration = true;
+    while (true) {
+        if (incrementalPhase == IncrementalPhase::Idle) {
+            if (oldGenerationUse - freeChunkBytes <= oldSpaceSize / 2) {
+                break;
+            }
+            freeChunks.clear();
+            freeChunkBytes = 0;
+            markStart = scannedOffset = oldGenerationUse;
+            for (Object *object : largeObjects) {
+                largeObjectMarks[largeObjectPage(object)] = 0;
+            }
+            std::memset(markBits, 0, markStart / alignof(Object) / 8 + 1);
+            // A major collection might have abandoned the last marking with cards left in the mod union table.
+            for (size_t card : modUnionCards) {
+                modUnionTable[card] = 0;
+            }
+            modUnionCards.clear();
+            remarkAttempts = 0;
+            markRootsInOldGeneration();
+            incrementalPhase = IncrementalPhase::Marking;
+        }
+        else if (incrementalPhase == IncrementalPhase::Marking) {
+            if (!drainMarkStack(budget) || !scanNewObjects(budget) || !rescanModUnionCards(budget) ||
+                !drainMarkStack(budget)) {
+                break;
+            }
+            markRootsInOldGeneration();
+            PauseBudget *remarkBudget = ++remarkAttempts < kMaxRemarkAttempts ? budget : nullptr;
+            if (!scanNewObjects(remarkBudget) || !rescanModUnionCards(remarkBudget) || !drainMarkStack(remarkBudget)) {
+                break;
+            }
+            deinitializeUnmarkedObjects();
+            sweepLargeObjectSpace([](Object *object) {
+                return (largeObjectMarks[largeObjectPage(object)] & kIncrementalMark) != 0;
+            });
+
+            sweepLimit = markStart;
+            sweepOffset = 0;
+            incrementalPhase = IncrementalPhase::Sweeping;
         }
         else {
-            deinitializationList[i]->klass->deinit(deinitializationList[i]);
+            if (!sweep(budget)) {
+                break;
+            }
+            incrementalPhase = IncrementalPhase::Idle;
+            statistics.incrementalCollections++;
+            break;
+        }
+    }
+    markingOldGeneration = false;
+}
+
+/// Grows the heap by @c heapGrowth percent until the survivors of the last major collection together with an object of
+/// @c minSpace bytes fill at most half of the old generation or until the heap reached its maximum size.
+void growHeap(size_t minSpace) {
+    size_t size = currentHeapSize;
+    while (size < maxHeapSize && (oldGenerationUse + minSpace) * 2 > oldSpaceSizeFor(size)) {
+        size = std::min(maxHeapSize, size + size * heapGrowth / 100);
+    }
+    if (size != currentHeapSize) {
+        resizeHeap(size);
+    }
+}
+
+inline size_t microseconds(std::chrono::steady_clock::duration duration) {
+    return static_cast<size_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+inline size_t heapUsed() {
+    return nurseryUse + oldGenerationUse - freeChunkBytes + largeObjectSpaceUse;
+}
+
+const char* incrementalPhaseName() {
+    switch (incrementalPhase) {
+        case IncrementalPhase::Idle:
+            return "idle";
+        case IncrementalPhase::Marking:
+            return "marking";
+        case IncrementalPhase::Sweeping:
+            return "sweeping";
+    }
+    return "";
+}
+
+const char* triggerName(Trigger trigger) {
+    switch (trigger) {
+        case Trigger::Nursery:
+            return "nursery";
+        case Trigger::LargeObject:
+            return "largeObject";
+        case Trigger::LargeObjectSpace:
+            return "largeObjectSpace";
+        case Trigger::HeapProfile:
+            return "heapProfile";
+    }
+    return "";
+}
+
+/// Describes a garbage collection while it runs. It is added to the statistics and the log once it ended.
+struct CollectionRecord {
+    /// The name of the allocation that requested the collection.
+    const char *trigger;
+    /// Whether the collection copied the old generation.
+    bool major = false;
+    std::chrono::steady_clock::time_point requested;
+    std::chrono::steady_clock::time_point paused;
+    size_t bytesUsedBefore;
+    /// The statistics when the collection began.
+    GarbageCollectionStatistics before;
+};
+
+/// Adds @c record of the collection that is about to resume the threads to the statistics and writes it to the log.
+void recordCollection(const CollectionRecord &record) {
+    auto resumed = std::chrono::steady_clock::now();
+    size_t pause = microseconds(resumed - record.paused);
+    size_t bytesUsedAfter = heapUsed();
+    statistics.collections++;
+    statistics.majorCollections += record.major ? 1 : 0;
+    statistics.bytesFreed += record.bytesUsedBefore - std::min(record.bytesUsedBefore, bytesUsedAfter);
+    statistics.pauseMicroseconds += pause;
+    statistics.maxPauseMicroseconds = std::max(statistics.maxPauseMicroseconds, pause);
+    statistics.timeToPauseMicroseconds += microseconds(record.paused - record.requested);
+
+    if (gcLog != nullptr) {
+        fprintf(gcLog, "{\"collection\":%zu,\"trigger\":\"%s\",\"kind\":\"%s\",\"incrementalPhase\":\"%s\","
+                "\"threads\":%u,\"gcThreads\":%u,\"timeToPauseMicroseconds\":[", statistics.collections,
+                record.trigger, record.major ? "major" : "minor", incrementalPhaseName(),
+                ThreadsManager::threadsCount(), workerCount);
+        for (size_t i = 0; i < pauseArrivals.size(); i++) {
+            fprintf(gcLog, "%s%zu", i > 0 ? "," : "", microseconds(pauseArrivals[i] - record.requested));
+        }
+        fprintf(gcLog, "],\"pauseMicroseconds\":%zu,\"bytesBefore\":%zu,\"bytesAfter\":%zu,\"bytesCopied\":%zu,"
+                "\"objectsDeinitialized\":%zu,\"heapSize\":%zu}\n", pause, record.bytesUsedBefore, bytesUsedAfter,
+                statistics.bytesCopied - record.before.bytesCopied,
+                statistics.objectsDeinitialized - record.before.objectsDeinitialized, currentHeapSize);
+        fflush(gcLog);
+    }
+    pauseArrivals.clear();
+}
+
+/// Calls @c visit for every object in the old generation, the large object space and every pinned object. The nursery
+/// must be empty but for pinned objects.
+template <typename F>
+void forEachObject(F visit) {
+    for (auto objects : {&pinnedNurseryObjects, &pinnedOldObjects}) {
+        for (Object *object : *objects) {
+            visit(object);
+        }
+    }
+    for (Byte *byte = oldGeneration; byte < oldGeneration + oldGenerationUse;) {
+        auto object = reinterpret_cast<Object *>(byte);
+        byte += object->size;
+        if (object->klass != &fillerClass) {
+            visit(object);
+        }
+    }
+    for (Object *object : largeObjects) {
+        visit(object);
+    }
+}
+
+std::string className(const Class *klass) {
+    if (klass == CL_ARRAY) {
+        return "array";
+    }
+    if (klass->name == 0) {
+        return "box storage";
+    }
+    char name[5] = {};
+    u8_wc_toutf8(name, klass->name);
+    return name;
+}
+
+/// Writes the sampled allocation sites to @c allocationProfilePath, those that allocated the most bytes first. See
+/// README.md for the format.
+void writeAllocationProfile() {
+    FILE *profile = fopen(allocationProfilePath, "w");
+    if (profile == nullptr) {
+        error("Cannot open allocation profile %s.", allocationProfilePath);
+    }
+    std::vector<std::pair<AllocationSite, AllocationCounts>> sites;
+    {
+        std::lock_guard<std::mutex> lock(allocationSitesMutex);
+        sites.assign(allocationSites.begin(), allocationSites.end());
+    }
+    std::sort(sites.begin(), sites.end(), [](const std::pair<AllocationSite, AllocationCounts> &a,
+                                             const std::pair<AllocationSite, AllocationCounts> &b) {
+        return a.second.bytes > b.second.bytes;
+    });
+    fprintf(profile, "# bytes objects samples function offset class\n");
+    for (auto &site : sites) {
+        fprintf(profile, "%zu %zu %zu %s %zu %s\n", site.second.bytes, site.second.objects, site.second.samples,
+                site.first.function->name, site.first.offset, className(site.first.klass).c_str());
+    }
+    fclose(profile);
+}
+
+/// Writes the references of every object and of the roots to @c heapSnapshotPath with the number of the last collection
+/// appended. See README.md for the format.
+void writeHeapSnapshot() {
+    std::string path = std::string(heapSnapshotPath) + "." + std::to_string(statistics.collections);
+    FILE *snapshot = fopen(path.c_str(), "w");
+    if (snapshot == nullptr) {
+        error("Cannot open heap snapshot %s.", path.c_str());
+    }
+    std::unordered_map<Object *, size_t> ids;
+    forEachObject([&ids](Object *object) { ids.emplace(object, ids.size()); });
+
+    std::vector<Object *> references;
+    std::map<std::pair<std::string, std::string>, size_t> classReferences;
+    snapshotReferences = &references;
+    markRootsInOldGeneration();
+    fprintf(snapshot, "roots");
+    for (Object *reference : references) {
+        auto id = ids.find(reference);
+        if (id != ids.end()) {
+            fprintf(snapshot, " %zu", id->second);
         }
     }
-    deinitializationListIndex = place;
+    fprintf(snapshot, "\n");
+    forEachObject([&](Object *object) {
+        references.clear();
+        scanObject(object);
+        auto name = className(object->klass);
+        fprintf(snapshot, "%zu %s %zu", ids[object], name.c_str(), object->size);
+        for (Object *reference : references) {
+            auto id = ids.find(reference);
+            if (id != ids.end()) {
+                fprintf(snapshot, " %zu", id->second);
+                classReferences[std::make_pair(name, className(reference->klass))]++;
+            }
+        }
+        fprintf(snapshot, "\n");
+    });
+    snapshotReferences = nullptr;
+    for (auto &pair : classReferences) {
+        fprintf(snapshot, "references %s %s %zu\n", pair.first.first.c_str(), pair.first.second.c_str(), pair.second);
+    }
+    fclose(snapshot);
+}
+
+/// Writes the number and size of the live objects of every class to @c heapProfile. Must be called right after a major
+/// collection.
+void writeHeapProfile() {
+    std::unordered_map<const Class *, std::pair<size_t, size_t>> classes;
+    forEachObject([&classes](Object *object) {
+        auto &counts = classes[object->klass];
+        counts.first++;
+        counts.second += object->size;
+    });
+    std::vector<std::pair<const Class *, std::pair<size_t, size_t>>> sorted(classes.begin(), classes.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<const Class *, std::pair<size_t, size_t>> &a,
+                                               const std::pair<const Class *, std::pair<size_t, size_t>> &b) {
+        return a.second.second > b.second.second;
+    });
+
+    fprintf(heapProfile, "{\"collection\":%zu,\"heapBytesUsed\":%zu,\"classes\":[", statistics.collections,
+            heapUsed());
+    for (size_t i = 0; i < sorted.size(); i++) {
+        fprintf(heapProfile, "%s{\"class\":\"%s\",\"instances\":%zu,\"bytes\":%zu}", i > 0 ? "," : "",
+                className(sorted[i].first).c_str(), sorted[i].second.first, sorted[i].second.second);
+    }
+    fprintf(heapProfile, "]}\n");
+    fflush(heapProfile);
+    if (heapSnapshotPath != nullptr) {
+        writeHeapSnapshot();
+    }
+    if (allocationProfilePath != nullptr) {
+        writeAllocationProfile();
+    }
+}
+
+GarbageCollectionStatistics garbageCollectionStatistics() {
+    GarbageCollectionStatistics copy = statistics;
+    copy.heapBytes = currentHeapSize + largeObjectSpaceUse;
+    copy.heapBytesUsed = heapUsed();
+    return copy;
+}
+
+void gc(std::unique_lock<std::mutex> &garbageCollectionLock, size_t minSpace, Trigger trigger) {
+    bool large = trigger == Trigger::LargeObject;
+    CollectionRecord record;
+    record.trigger = triggerName(trigger);
+    record.requested = std::chrono::steady_clock::now();
+    pauseThreads = true;
+    if (minSpace > (trigger == Trigger::LargeObjectSpace ? largeObjectSpaceSize : maxOldSpaceSize)) {
+        error("Allocation of %zu bytes is too big. Try to enlarge the heap. (Maximum heap size: %zu)", minSpace,
+              maxHeapSize);
+    }
+
+    auto pausingThreadsCountLock = std::unique_lock<std::mutex>(pausingThreadsCountMutex);
+    pausingThreadsCount++;
+
+    pausingThreadsCountCondition.wait(pausingThreadsCountLock, []{
+        return pausingThreadsCount == ThreadsManager::threadsCount();
+    });
+
+    std::lock_guard<std::mutex> threadListLock(ThreadsManager::threadListMutex);
+    std::unique_lock<std::mutex> finalizerQueueLock(finalizerQueue->mutex);
+    record.paused = std::chrono::steady_clock::now();
+    record.bytesUsedBefore = heapUsed();
+    record.before = statistics;
+    startWorkers();
+    // Profiles are taken of the compacted heap, which only contains live objects.
+    bool profile = heapProfile != nullptr && (heapProfileRequested.exchange(false) ||
+                                              statistics.collections + 1 == heapProfileCollection);
+    collectNursery();
+
+    // Collecting the old generation is only worth it if the survivors of the nursery left less than a nursery’s worth
+    // of free space. Only major collections free arrays in the large object space.
+    if (oldSpaceSize - oldGenerationUse < promotionSpace(nurserySize) + (large ? minSpace : 0) ||
+        trigger == Trigger::LargeObjectSpace || profile) {
+        collectOldGeneration();
+        growHeap(large ? minSpace : 0);
+        record.major = true;
+        // The large object space may grow to twice what survived, like the old generation.
+        size_t largeObjectsNeeded = largeObjectSpaceUse + (trigger == Trigger::LargeObjectSpace ? minSpace : 0);
+        largeObjectSpaceLimit = std::min(largeObjectSpaceSize, std::max(oldSpaceSize, 2 * largeObjectsNeeded));
+    }
+    else if (pauseBudget.count() > 0) {
+        PauseBudget budget(record.paused + pauseBudget);
+        collectIncrementally(&budget);
+    }
+
+    // The nursery may only fill up as far as its survivors are guaranteed to fit into the old generation.
+    size_t free = oldSpaceSize - oldGenerationUse;
+    size_t reserve = promotionSpace(0) + (large ? minSpace : 0);
+    nurseryLimit = free > reserve ? std::min<size_t>(nurserySize, (free - reserve) / 16 * 15) : 0;
+    if (large ? free < reserve : trigger == Trigger::Nursery && nurseryLimit < minSpace) {
+        error("Terminating program due to too high memory pressure.");
+    }
+    recordCollection(record);
+    if (profile) {
+        writeHeapProfile();
+    }
 
+    finalizerQueueLock.unlock();
     pausingThreadsCount--;
     pauseThreads = false;
     garbageCollectionLock.unlock();
 
     pauseThreadsCondition.notify_all();
     pausingThreadsCountLock.unlock();
+    finalizerQueue->condition.notify_one();
 }
 
 void pauseForGC() {
@@ -288,12 +2223,21 @@ void pauseForGC() {
 
 inline void performPauseForGC() {
     auto pausingThreadsCountLock = std::unique_lock<std::mutex>(pausingThreadsCountMutex);
+    pauseArrivals.emplace_back(std::chrono::steady_clock::now());
     pausingThreadsCount++;
     pausingThreadsCountCondition.notify_one();
     pauseThreadsCondition.wait(pausingThreadsCountLock, []{ return !pauseThreads; });
     pausingThreadsCount--;
 }
 
+/// Deallocates @c thread, which finished executing, and wakes a garbage collection that waits for the remaining threads
+/// to pause.
+void deallocateFinishedThread(Thread *thread) {
+    ThreadsManager::deallocateThread(thread);
+    std::lock_guard<std::mutex> pausingThreadsCountLock(pausingThreadsCountMutex);
+    pausingThreadsCountCondition.notify_one();
+}
+
 void allowGC() {
     std::unique_lock<std::mutex> pausingThreadsCountLock(pausingThreadsCountMutex);
     pausingThreadsCount++;
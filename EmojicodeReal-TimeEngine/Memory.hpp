@@ -10,13 +10,27 @@
 #define Object_hpp
 
 #include "Engine.hpp"
+#include <atomic>
 
 namespace Emojicode {
 
 #ifndef heapSize
+/// The default maximum size of the heap, which can be changed with the environment variable
+/// @c EMOJICODE_MAX_HEAP_SIZE.
 #define heapSize (512 * 1024 * 1024)  // 512 MB
 #endif
 
+/// The number of bytes of the old generation covered by one entry of the card table.
+const size_t kCardSize = 512;
+/// The size of the address space reserved for each semispace of the old generation, into which the semispace grows.
+extern size_t maxOldSpaceSize;
+
+/// The semispace of the old generation in which objects currently live.
+extern Byte *oldGeneration;
+/// A byte for every card of @c oldGeneration. Non-zero if a reference might have been stored on the card since the
+/// last garbage collection.
+extern Byte *cardTable;
+
 inline size_t alignSize(size_t size) {
     return size + alignof(Object) - (size % alignof(Object));
 }
@@ -25,6 +39,37 @@ inline size_t alignSize(size_t size) {
 /// @warning Obviously, you should not call it anywhere else!
 void allocateHeap();
 
+/// Cumulative statistics about the garbage collections since the program started.
+struct GarbageCollectionStatistics {
+    /// The number of garbage collections. Every garbage collection collects the nursery.
+    size_t collections = 0;
+    /// The number of garbage collections that also copied the old generation.
+    size_t majorCollections = 0;
+    /// The number of completed incremental collections of the old generation.
+    size_t incrementalCollections = 0;
+    /// The number of bytes copied from the nursery or the other semispace into the old generation.
+    size_t bytesCopied = 0;
+    /// The number of bytes by which garbage collections reduced the used part of the heap.
+    size_t bytesFreed = 0;
+    /// The number of unreachable objects handed to the finalizer thread, which calls their deinitializers.
+    size_t objectsDeinitialized = 0;
+    /// The total and the longest time threads were paused for garbage collections.
+    size_t pauseMicroseconds = 0;
+    size_t maxPauseMicroseconds = 0;
+    /// The total time between garbage collections being requested and all threads being paused.
+    size_t timeToPauseMicroseconds = 0;
+    /// The current size of the heap and the number of bytes used in it.
+    size_t heapBytes = 0;
+    size_t heapBytesUsed = 0;
+};
+
+/// Returns the garbage collection statistics. Must be called by a thread that can be paused for garbage collection.
+GarbageCollectionStatistics garbageCollectionStatistics();
+
+/// Set while the garbage collector waits for all threads to pause. Threads that do not allocate poll it at safepoints,
+/// i.e. on function entry and backward jumps, so that loops without allocations cannot hold up garbage collection.
+extern std::atomic_bool pauseThreads;
+
 /// This method pauses the thread as if the garbage collector requested it.
 /// @warning You should normally not call this method.
 inline void performPauseForGC();
@@ -52,9 +97,21 @@ inline void markByObjectVariableRecord(ObjectVariableRecord &record, Value *va,
     }
 }
 
+/// Remembers that a reference might have been stored at @c address so that the next minor garbage collection scans
+/// the objects on the card of @c address for references into the nursery. Does nothing if @c address does not lie in
+/// the old generation.
+/// @see writeBarrier()
+inline void recordWrite(const void *address) {
+    auto offset = static_cast<size_t>(static_cast<const Byte *>(address) - oldGeneration);
+    if (offset < maxOldSpaceSize) {
+        cardTable[offset / kCardSize] = 1;
+    }
+}
+
 void markValueReference(Value **valuePointer);
 void markBox(Box *box);
 void registerForDeinitialization(Object *object);
+void deallocateFinishedThread(Thread *thread);
 
 }
 
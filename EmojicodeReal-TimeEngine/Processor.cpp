@@ -10,9 +10,12 @@
 #include "../EmojicodeInstructions.h"
 #include "Class.hpp"
 #include "Dictionary.hpp"
+#include "JIT.hpp"
 #include "List.hpp"
+#include "Memory.hpp"
 #include "String.hpp"
 #include "Thread.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <functional>
@@ -20,13 +23,6 @@
 
 namespace Emojicode {
 
-inline double readDouble(Thread *thread) {
-    EmojicodeInteger scale = (static_cast<EmojicodeInteger>(thread->consumeInstruction()) << 32) ^ thread->consumeInstruction();
-    EmojicodeInteger exp = thread->consumeInstruction();
-
-    return ldexp(static_cast<double>(scale)/PORTABLE_INTLEAST64_MAX, static_cast<int>(exp));
-}
-
 void loadCapture(Closure *c, Thread *thread) {
     if (c->captureSize == 0) {
         return;
@@ -45,82 +41,501 @@ void executeCallableExtern(Object *callable, Value *args, size_t argsSize, Threa
     thread->deconfigureInterruption(interupt);
 }
 
+#ifdef threadedDispatch
+/// All instructions fit into one byte. The dispatch table is indexed with the masked instruction and thus needs no
+/// bounds check. Unused entries point to the illegal instruction handler.
+const size_t kDispatchTableSize = 0x100;
+/// Maps every instruction to the address of its handler in @c execute(). Filled by @c prepareInterpreter().
+void *dispatchTable[kDispatchTableSize];
+/// Labels as values are a GNU extension, about which -pedantic warns. The warning is only silenced where they are used.
+#define LABELS_AS_VALUES(code) \
+    _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wpedantic\"") code _Pragma("GCC diagnostic pop")
+#define INSTRUCTION(ins) case ins: L_##ins:
+#define NEXT_INSTRUCTION() LABELS_AS_VALUES(goto *(ip++)->handler;)
+#else
+#define INSTRUCTION(ins) case ins:
+#define NEXT_INSTRUCTION() continue
+#endif
+
+/// The execution pointer is kept in @c ip while a function is executed. It must be stored into the stack frame
+/// before anything is called that might inspect the stack, i.e. allocations, calls and natives.
+#define SAVE_IP() thread->currentStackFrame()->executionPointer = ip
+#define LOAD_IP() ip = thread->currentStackFrame()->executionPointer
+
 inline EmojicodeInteger normalizedBoxType(EmojicodeInteger type) {
     return type & ~REMOTE_MASK;
 }
 
+/// Runs the machine code of the current function from @c ip on if the JIT compiled the instruction at @c ip.
+/// @returns The execution pointer at which the interpreter must continue.
+inline InstructionCell* runCompiled(Thread *thread, InstructionCell *ip) {
+    Function *function = thread->currentStackFrame()->function;
+    CompiledFunction *compiled = function->compiled;
+    if (compiled == nullptr || compiled->entries == nullptr) {
+        return ip;
+    }
+    const void *entry = compiled->entries[ip - function->block.cells];
+    if (entry == nullptr) {
+        return ip;
+    }
+    return compiled->run(thread->variableDestination(0), thread->operandStackPointer(), entry);
+}
+
+/// Like @c runCompiled() but counts the execution towards the JIT threshold first and compiles the function once
+/// the threshold is exceeded. Used on function entry and backward jumps, which are also the safepoints at which the
+/// thread pauses if the garbage collector is waiting for it.
+inline InstructionCell* countAndRunCompiled(Thread *thread, InstructionCell *ip) {
+    if (pauseThreads) {
+        // The variables are marked as if the instruction at ip was being executed. Arguments and variables initialized
+        // right before ip are only considered initialized once the instruction began.
+        thread->currentStackFrame()->executionPointer = ip + 1;
+        pauseForGC();
+    }
+    Function *function = thread->currentStackFrame()->function;
+    if (function->compiled == nullptr) {
+        if (!jitEnabled || ++function->hotness <= jitThreshold) {
+            return ip;
+        }
+        compileFunction(function);
+    }
+    return runCompiled(thread, ip);
+}
+
+/// Pushes a stack frame for @c function, whose arguments are on the operand stack, and returns the execution pointer
+/// of the new frame. @c ip must point to the argument size operand of the calling instruction.
+inline InstructionCell* call(Thread *thread, InstructionCell *ip, Value self, Function *function) {
+    if (function->leafHandler != nullptr) {
+        Value **stackPointer = thread->operandStackPointer();
+        *stackPointer = function->leafHandler(self, *stackPointer - ip->operand);
+        return ip + 1;
+    }
+    SAVE_IP();
+    return countAndRunCompiled(thread, thread->pushStackFrame(self, true, function)->executionPointer);
+}
+
+/// Like @c call() but replaces the stack frame of the current function with the one of @c function so that the call
+/// needs no additional stack space. Falls back to @c call() if @c self refers to a value in the current stack frame or
+/// @c function is a leaf native, which needs no stack frame anyway, in which case the calling instruction’s subsequent
+/// @c INS_RETURN returns the value.
+inline InstructionCell* tailCall(Thread *thread, InstructionCell *ip, Value self, Function *function) {
+    if (function->leafHandler != nullptr ||
+        (function->context == ContextType::ValueReference && thread->currentStackFrameContains(self.value))) {
+        return call(thread, ip, self, function);
+    }
+    SAVE_IP();
+    return countAndRunCompiled(thread, thread->replaceStackFrame(self, function)->executionPointer);
+}
+
+/// Calls the method that an intrinsic instruction replaced on @c self like @c INS_DISPATCH_METHOD would.
+/// @c ip must point to the cache operand of the intrinsic instruction.
+inline InstructionCell* callIntrinsicMethod(Thread *thread, InstructionCell *ip, Value self) {
+    auto cache = ip->cache;
+    Class *klass = self.object->klass;
+    return call(thread, ip + 1, self, cache->dispatch(klass, [klass, cache]() {
+        return klass->methodsVtable[cache->vti];
+    }));
+}
+
+InstructionCell instructionCell(EmojicodeInstruction instruction) {
+    InstructionCell cell{};
+#ifdef threadedDispatch
+    cell.handler = dispatchTable[instruction & (kDispatchTableSize - 1)];
+#else
+    cell.instruction = instruction;
+#endif
+    return cell;
+}
+
+void prepareInterpreter() {
+#ifdef threadedDispatch
+    execute(nullptr);
+#endif
+}
+
 void execute(Thread *thread) {
+#ifdef threadedDispatch
+    if (thread == nullptr) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+        std::fill(dispatchTable, dispatchTable + kDispatchTableSize, &&L_ILLEGAL_INSTRUCTION);
+        dispatchTable[INS_DISPATCH_METHOD] = &&L_INS_DISPATCH_METHOD;
+        dispatchTable[INS_DISPATCH_TYPE_METHOD] = &&L_INS_DISPATCH_TYPE_METHOD;
+        dispatchTable[INS_DISPATCH_PROTOCOL] = &&L_INS_DISPATCH_PROTOCOL;
+        dispatchTable[INS_NEW_OBJECT] = &&L_INS_NEW_OBJECT;
+        dispatchTable[INS_DISPATCH_SUPER] = &&L_INS_DISPATCH_SUPER;
+        dispatchTable[INS_REGISTER_MOVE_R] = &&L_INS_REGISTER_MOVE_R;
+        dispatchTable[INS_REGISTER_MOVE_I] = &&L_INS_REGISTER_MOVE_I;
+#define REGISTER_OPERATION_LABELS(name, op) \
+        dispatchTable[INS_REGISTER_##name##_RR] = &&L_INS_REGISTER_##name##_RR; \
+        dispatchTable[INS_REGISTER_##name##_RR_PUSH] = &&L_INS_REGISTER_##name##_RR_PUSH; \
+        dispatchTable[INS_REGISTER_##name##_RI] = &&L_INS_REGISTER_##name##_RI; \
+        dispatchTable[INS_REGISTER_##name##_RI_PUSH] = &&L_INS_REGISTER_##name##_RI_PUSH; \
+        dispatchTable[INS_REGISTER_##name##_IR] = &&L_INS_REGISTER_##name##_IR; \
+        dispatchTable[INS_REGISTER_##name##_IR_PUSH] = &&L_INS_REGISTER_##name##_IR_PUSH;
+        REGISTER_OPERATIONS(REGISTER_OPERATION_LABELS)
+#undef REGISTER_OPERATION_LABELS
+        dispatchTable[INS_CALL_CONTEXTED_FUNCTION] = &&L_INS_CALL_CONTEXTED_FUNCTION;
+        dispatchTable[INS_CALL_FUNCTION] = &&L_INS_CALL_FUNCTION;
+        dispatchTable[INS_TAIL_CALL_DISPATCH_METHOD] = &&L_INS_TAIL_CALL_DISPATCH_METHOD;
+        dispatchTable[INS_TAIL_CALL_DISPATCH_TYPE_METHOD] = &&L_INS_TAIL_CALL_DISPATCH_TYPE_METHOD;
+        dispatchTable[INS_TAIL_CALL_DISPATCH_PROTOCOL] = &&L_INS_TAIL_CALL_DISPATCH_PROTOCOL;
+        dispatchTable[INS_TAIL_CALL_CONTEXTED_FUNCTION] = &&L_INS_TAIL_CALL_CONTEXTED_FUNCTION;
+        dispatchTable[INS_TAIL_CALL_FUNCTION] = &&L_INS_TAIL_CALL_FUNCTION;
+        dispatchTable[INS_INTRINSIC_LIST_COUNT] = &&L_INS_INTRINSIC_LIST_COUNT;
+        dispatchTable[INS_INTRINSIC_LIST_GET] = &&L_INS_INTRINSIC_LIST_GET;
+        dispatchTable[INS_INTRINSIC_LIST_SET] = &&L_INS_INTRINSIC_LIST_SET;
+        dispatchTable[INS_INTRINSIC_LIST_APPEND] = &&L_INS_INTRINSIC_LIST_APPEND;
+        dispatchTable[INS_INTRINSIC_STRING_LENGTH] = &&L_INS_INTRINSIC_STRING_LENGTH;
+        dispatchTable[INS_INTRINSIC_STRING_SYMBOL_AT] = &&L_INS_INTRINSIC_STRING_SYMBOL_AT;
+        dispatchTable[INS_INTRINSIC_INTEGER_ABSOLUTE] = &&L_INS_INTRINSIC_INTEGER_ABSOLUTE;
+        dispatchTable[INS_INTRINSIC_DOUBLE_SQRT] = &&L_INS_INTRINSIC_DOUBLE_SQRT;
+        dispatchTable[INS_INTRINSIC_DOUBLE_FLOOR] = &&L_INS_INTRINSIC_DOUBLE_FLOOR;
+        dispatchTable[INS_SIMPLE_OPTIONAL_PRODUCE] = &&L_INS_SIMPLE_OPTIONAL_PRODUCE;
+        dispatchTable[INS_PUSH_ERROR] = &&L_INS_PUSH_ERROR;
+        dispatchTable[INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE] = &&L_INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE;
+        dispatchTable[INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE_REMOTE] = &&L_INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE_REMOTE;
+        dispatchTable[INS_SIMPLE_OPTIONAL_TO_BOX] = &&L_INS_SIMPLE_OPTIONAL_TO_BOX;
+        dispatchTable[INS_SIMPLE_OPTIONAL_TO_BOX_REMOTE] = &&L_INS_SIMPLE_OPTIONAL_TO_BOX_REMOTE;
+        dispatchTable[INS_PUSH_N] = &&L_INS_PUSH_N;
+        dispatchTable[INS_POP] = &&L_INS_POP;
+        dispatchTable[INS_BOX_PRODUCE] = &&L_INS_BOX_PRODUCE;
+        dispatchTable[INS_BOX_PRODUCE_REMOTE] = &&L_INS_BOX_PRODUCE_REMOTE;
+        dispatchTable[INS_UNBOX] = &&L_INS_UNBOX;
+        dispatchTable[INS_UNBOX_REMOTE] = &&L_INS_UNBOX_REMOTE;
+        dispatchTable[INS_PUSH_VT_REFERENCE_STACK] = &&L_INS_PUSH_VT_REFERENCE_STACK;
+        dispatchTable[INS_PUSH_VT_REFERENCE_OBJECT] = &&L_INS_PUSH_VT_REFERENCE_OBJECT;
+        dispatchTable[INS_PUSH_VT_REFERENCE_VT] = &&L_INS_PUSH_VT_REFERENCE_VT;
+        dispatchTable[INS_PUSH_STACK_REFERENCE_N_BACK] = &&L_INS_PUSH_STACK_REFERENCE_N_BACK;
+        dispatchTable[INS_GET_CLASS_FROM_INSTANCE] = &&L_INS_GET_CLASS_FROM_INSTANCE;
+        dispatchTable[INS_GET_CLASS_FROM_INDEX] = &&L_INS_GET_CLASS_FROM_INDEX;
+        dispatchTable[INS_GET_STRING_POOL] = &&L_INS_GET_STRING_POOL;
+        dispatchTable[INS_GET_TRUE] = &&L_INS_GET_TRUE;
+        dispatchTable[INS_GET_FALSE] = &&L_INS_GET_FALSE;
+        dispatchTable[INS_GET_32_INTEGER] = &&L_INS_GET_32_INTEGER;
+        dispatchTable[INS_GET_64_INTEGER] = &&L_INS_GET_64_INTEGER;
+        dispatchTable[INS_GET_DOUBLE] = &&L_INS_GET_DOUBLE;
+        dispatchTable[INS_GET_SYMBOL] = &&L_INS_GET_SYMBOL;
+        dispatchTable[INS_GET_NOTHINGNESS] = &&L_INS_GET_NOTHINGNESS;
+        dispatchTable[INS_COPY_TO_STACK] = &&L_INS_COPY_TO_STACK;
+        dispatchTable[INS_COPY_TO_INSTANCE_VARIABLE] = &&L_INS_COPY_TO_INSTANCE_VARIABLE;
+        dispatchTable[INS_COPY_VT_VARIABLE] = &&L_INS_COPY_VT_VARIABLE;
+        dispatchTable[INS_COPY_TO_STACK_SIZE] = &&L_INS_COPY_TO_STACK_SIZE;
+        dispatchTable[INS_COPY_TO_INSTANCE_VARIABLE_SIZE] = &&L_INS_COPY_TO_INSTANCE_VARIABLE_SIZE;
+        dispatchTable[INS_COPY_VT_VARIABLE_SIZE] = &&L_INS_COPY_VT_VARIABLE_SIZE;
+        dispatchTable[INS_PUSH_SINGLE_STACK] = &&L_INS_PUSH_SINGLE_STACK;
+        dispatchTable[INS_PUSH_WITH_SIZE_STACK] = &&L_INS_PUSH_WITH_SIZE_STACK;
+        dispatchTable[INS_PUSH_SINGLE_OBJECT] = &&L_INS_PUSH_SINGLE_OBJECT;
+        dispatchTable[INS_PUSH_WITH_SIZE_OBJECT] = &&L_INS_PUSH_WITH_SIZE_OBJECT;
+        dispatchTable[INS_PUSH_SINGLE_VT] = &&L_INS_PUSH_SINGLE_VT;
+        dispatchTable[INS_PUSH_WITH_SIZE_VT] = &&L_INS_PUSH_WITH_SIZE_VT;
+        dispatchTable[INS_PUSH_VALUE_FROM_REFERENCE] = &&L_INS_PUSH_VALUE_FROM_REFERENCE;
+        dispatchTable[INS_EQUAL_PRIMITIVE] = &&L_INS_EQUAL_PRIMITIVE;
+        dispatchTable[INS_EQUAL_SYMBOL] = &&L_INS_EQUAL_SYMBOL;
+        dispatchTable[INS_SUBTRACT_INTEGER] = &&L_INS_SUBTRACT_INTEGER;
+        dispatchTable[INS_ADD_INTEGER] = &&L_INS_ADD_INTEGER;
+        dispatchTable[INS_INCREMENT] = &&L_INS_INCREMENT;
+        dispatchTable[INS_DECREMENT] = &&L_INS_DECREMENT;
+        dispatchTable[INS_ADD_INTEGER_IMMEDIATE_TO_STACK] = &&L_INS_ADD_INTEGER_IMMEDIATE_TO_STACK;
+        dispatchTable[INS_MULTIPLY_INTEGER] = &&L_INS_MULTIPLY_INTEGER;
+        dispatchTable[INS_DIVIDE_INTEGER] = &&L_INS_DIVIDE_INTEGER;
+        dispatchTable[INS_REMAINDER_INTEGER] = &&L_INS_REMAINDER_INTEGER;
+        dispatchTable[INS_INVERT_BOOLEAN] = &&L_INS_INVERT_BOOLEAN;
+        dispatchTable[INS_OR_BOOLEAN] = &&L_INS_OR_BOOLEAN;
+        dispatchTable[INS_AND_BOOLEAN] = &&L_INS_AND_BOOLEAN;
+        dispatchTable[INS_GREATER_INTEGER] = &&L_INS_GREATER_INTEGER;
+        dispatchTable[INS_GREATER_OR_EQUAL_INTEGER] = &&L_INS_GREATER_OR_EQUAL_INTEGER;
+        dispatchTable[INS_SAME_OBJECT] = &&L_INS_SAME_OBJECT;
+        dispatchTable[INS_IS_NOTHINGNESS] = &&L_INS_IS_NOTHINGNESS;
+        dispatchTable[INS_IS_ERROR] = &&L_INS_IS_ERROR;
+        dispatchTable[INS_EQUAL_DOUBLE] = &&L_INS_EQUAL_DOUBLE;
+        dispatchTable[INS_SUBTRACT_DOUBLE] = &&L_INS_SUBTRACT_DOUBLE;
+        dispatchTable[INS_ADD_DOUBLE] = &&L_INS_ADD_DOUBLE;
+        dispatchTable[INS_MULTIPLY_DOUBLE] = &&L_INS_MULTIPLY_DOUBLE;
+        dispatchTable[INS_DIVIDE_DOUBLE] = &&L_INS_DIVIDE_DOUBLE;
+        dispatchTable[INS_GREATER_DOUBLE] = &&L_INS_GREATER_DOUBLE;
+        dispatchTable[INS_GREATER_OR_EQUAL_DOUBLE] = &&L_INS_GREATER_OR_EQUAL_DOUBLE;
+        dispatchTable[INS_REMAINDER_DOUBLE] = &&L_INS_REMAINDER_DOUBLE;
+        dispatchTable[INS_BINARY_AND_INTEGER] = &&L_INS_BINARY_AND_INTEGER;
+        dispatchTable[INS_BINARY_OR_INTEGER] = &&L_INS_BINARY_OR_INTEGER;
+        dispatchTable[INS_BINARY_XOR_INTEGER] = &&L_INS_BINARY_XOR_INTEGER;
+        dispatchTable[INS_BINARY_NOT_INTEGER] = &&L_INS_BINARY_NOT_INTEGER;
+        dispatchTable[INS_SHIFT_LEFT_INTEGER] = &&L_INS_SHIFT_LEFT_INTEGER;
+        dispatchTable[INS_SHIFT_RIGHT_INTEGER] = &&L_INS_SHIFT_RIGHT_INTEGER;
+        dispatchTable[INS_INT_TO_DOUBLE] = &&L_INS_INT_TO_DOUBLE;
+        dispatchTable[INS_UNWRAP_SIMPLE_OPTIONAL] = &&L_INS_UNWRAP_SIMPLE_OPTIONAL;
+        dispatchTable[INS_UNWRAP_BOX_OPTIONAL] = &&L_INS_UNWRAP_BOX_OPTIONAL;
+        dispatchTable[INS_ERROR_CHECK_SIMPLE_OPTIONAL] = &&L_INS_ERROR_CHECK_SIMPLE_OPTIONAL;
+        dispatchTable[INS_ERROR_CHECK_BOX_OPTIONAL] = &&L_INS_ERROR_CHECK_BOX_OPTIONAL;
+        dispatchTable[INS_THIS] = &&L_INS_THIS;
+        dispatchTable[INS_SUPER_INITIALIZER] = &&L_INS_SUPER_INITIALIZER;
+        dispatchTable[INS_DOWNCAST_TO_CLASS] = &&L_INS_DOWNCAST_TO_CLASS;
+        dispatchTable[INS_CAST_TO_CLASS] = &&L_INS_CAST_TO_CLASS;
+        dispatchTable[INS_CAST_TO_PROTOCOL] = &&L_INS_CAST_TO_PROTOCOL;
+        dispatchTable[INS_CAST_TO_VALUE_TYPE] = &&L_INS_CAST_TO_VALUE_TYPE;
+        dispatchTable[INS_RETURN] = &&L_INS_RETURN;
+        dispatchTable[INS_JUMP_FORWARD] = &&L_INS_JUMP_FORWARD;
+        dispatchTable[INS_JUMP_FORWARD_IF] = &&L_INS_JUMP_FORWARD_IF;
+        dispatchTable[INS_JUMP_BACKWARD_IF] = &&L_INS_JUMP_BACKWARD_IF;
+        dispatchTable[INS_JUMP_FORWARD_IF_NOT] = &&L_INS_JUMP_FORWARD_IF_NOT;
+        dispatchTable[INS_JUMP_BACKWARD_IF_NOT] = &&L_INS_JUMP_BACKWARD_IF_NOT;
+#define STACK_IMMEDIATE_JUMP_LABELS(name, op) \
+        dispatchTable[INS_JUMP_BACKWARD_IF_STACK_##name##_IMMEDIATE] = &&L_INS_JUMP_BACKWARD_IF_STACK_##name##_IMMEDIATE; \
+        dispatchTable[INS_JUMP_FORWARD_IF_NOT_STACK_##name##_IMMEDIATE] = \
+            &&L_INS_JUMP_FORWARD_IF_NOT_STACK_##name##_IMMEDIATE;
+        STACK_IMMEDIATE_COMPARISONS(STACK_IMMEDIATE_JUMP_LABELS)
+#undef STACK_IMMEDIATE_JUMP_LABELS
+        dispatchTable[INS_TRANSFER_CONTROL_TO_NATIVE] = &&L_INS_TRANSFER_CONTROL_TO_NATIVE;
+        dispatchTable[INS_EXECUTE_CALLABLE] = &&L_INS_EXECUTE_CALLABLE;
+        dispatchTable[INS_CLOSURE] = &&L_INS_CLOSURE;
+        dispatchTable[INS_CLOSURE_BOX] = &&L_INS_CLOSURE_BOX;
+        dispatchTable[INS_CAPTURE_METHOD] = &&L_INS_CAPTURE_METHOD;
+        dispatchTable[INS_CAPTURE_TYPE_METHOD] = &&L_INS_CAPTURE_TYPE_METHOD;
+        dispatchTable[INS_CAPTURE_CONTEXTED_FUNCTION] = &&L_INS_CAPTURE_CONTEXTED_FUNCTION;
+#pragma GCC diagnostic pop
+        return;
+    }
+#endif
+    InstructionCell *ip;
+    LOAD_IP();
+    ip = countAndRunCompiled(thread, ip);
+#ifdef threadedDispatch
+    NEXT_INSTRUCTION();
+#endif
     while (true) {
-        auto i = static_cast<Instructions>(thread->consumeInstruction());
+        auto i = (ip++)->instruction;
 #ifdef DEBUG
-        printf("%4ld: ", thread->currentStackFrame()->executionPointer -
-               thread->currentStackFrame()->function->block.instructions - 1);
-        pinsname(i);
+        printf("%4ld: ", ip - thread->currentStackFrame()->function->block.cells - 1);
+        pinsname(static_cast<Instructions>(i));
         puts("");
 #endif
         switch (i) {
-            case INS_DISPATCH_METHOD: {
-                EmojicodeInstruction vti = thread->consumeInstruction();
+            INSTRUCTION(INS_DISPATCH_METHOD) {
+                auto cache = (ip++)->cache;
                 Value v = thread->popOpr();
-                thread->pushStackFrame(v, true, v.object->klass->methodsVtable[vti]);
-                continue;
+                Class *klass = v.object->klass;
+                ip = call(thread, ip, v, cache->dispatch(klass, [klass, cache]() {
+                    return klass->methodsVtable[cache->vti];
+                }));
+                NEXT_INSTRUCTION();
             }
-            case INS_DISPATCH_TYPE_METHOD: {
+            INSTRUCTION(INS_DISPATCH_TYPE_METHOD) {
                 Value v = thread->popOpr();
-                EmojicodeInstruction vti = thread->consumeInstruction();
-                thread->pushStackFrame(v, true, v.klass->methodsVtable[vti]);
-                continue;
+                auto vti = (ip++)->operand;
+                ip = call(thread, ip, v, v.klass->methodsVtable[vti]);
+                NEXT_INSTRUCTION();
             }
-            case INS_DISPATCH_PROTOCOL: {
-                EmojicodeInstruction pti = thread->consumeInstruction();
-                EmojicodeInstruction vti = thread->consumeInstruction();
+            INSTRUCTION(INS_DISPATCH_PROTOCOL) {
+                auto cache = ip->cache;
+                ip += 2;
 
                 auto v = thread->popOpr();
 
                 auto type = v.value[0].raw;
                 if (type == T_OBJECT) {
-                    Object *o = v.value[1].object;
-                    thread->pushStackFrame(v.value[1], true, o->klass->protocolTable.dispatch(pti, vti));
+                    Class *klass = v.value[1].object->klass;
+                    ip = call(thread, ip, v.value[1], cache->dispatch(klass, [klass, cache]() {
+                        return klass->protocolTable.dispatch(cache->pti, cache->vti);
+                    }));
+                    NEXT_INSTRUCTION();
                 }
-                else if ((type & REMOTE_MASK) != 0) {
-                    auto protocol = protocolDispatchTableTable[normalizedBoxType(type) - protocolDTTOffset];
-                    thread->pushStackFrame(v.value[1].object->val<Value>(), true, protocol.dispatch(pti, vti));
+
+                auto typeId = normalizedBoxType(type);
+                auto function = protocolDispatchTableTable[typeId - protocolDTTOffset].dispatch(cache->pti, cache->vti);
+                if ((type & REMOTE_MASK) != 0) {
+                    ip = call(thread, ip, v.value[1].object->val<Value>(), function);
                 }
                 else {
-                    thread->pushStackFrame(v.value + 1, true,
-                                           protocolDispatchTableTable[type - protocolDTTOffset].dispatch(pti, vti));
+                    ip = call(thread, ip, v.value + 1, function);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_NEW_OBJECT: {
+            INSTRUCTION(INS_NEW_OBJECT) {
                 Class *klass = thread->popOpr().klass;
+                SAVE_IP();
                 Object *object = newObject(klass);
-                Function *initializer = klass->initializersVtable[thread->consumeInstruction()];
-                thread->pushStackFrame(object, true, initializer);
-                continue;
+                Function *initializer = klass->initializersVtable[(ip++)->operand];
+                ip = call(thread, ip, object, initializer);
+                NEXT_INSTRUCTION();
             }
-            case INS_DISPATCH_SUPER: {
+            INSTRUCTION(INS_DISPATCH_SUPER) {
                 Class *klass = thread->popOpr().klass;
-                EmojicodeInstruction vti = thread->consumeInstruction();
-                thread->pushStackFrame(thread->thisContext(), true, klass->methodsVtable[vti]);
-                continue;
-            }
-            case INS_CALL_CONTEXTED_FUNCTION:
-                thread->pushStackFrame(thread->popOpr(), true, functionTable[thread->consumeInstruction()]);
-                continue;
-            case INS_CALL_FUNCTION:
-                thread->pushStackFrame(Value(), true, functionTable[thread->consumeInstruction()]);
-                continue;
-            case INS_SIMPLE_OPTIONAL_PRODUCE: {
+                auto cache = (ip++)->cache;
+                ip = call(thread, ip, thread->thisContext(), cache->dispatch(klass,
+                                                                               [klass, cache]() {
+                    return klass->methodsVtable[cache->vti];
+                }));
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_CALL_CONTEXTED_FUNCTION)
+                ip = call(thread, ip + 1, thread->popOpr(), ip->function);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_CALL_FUNCTION)
+                ip = call(thread, ip + 1, Value(), ip->function);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_TAIL_CALL_DISPATCH_METHOD) {
+                auto cache = (ip++)->cache;
+                Value v = thread->popOpr();
+                Class *klass = v.object->klass;
+                ip = tailCall(thread, ip, v, cache->dispatch(klass, [klass, cache]() {
+                    return klass->methodsVtable[cache->vti];
+                }));
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_TAIL_CALL_DISPATCH_TYPE_METHOD) {
+                Value v = thread->popOpr();
+                auto vti = (ip++)->operand;
+                ip = tailCall(thread, ip, v, v.klass->methodsVtable[vti]);
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_TAIL_CALL_DISPATCH_PROTOCOL) {
+                auto cache = ip->cache;
+                ip += 2;
+
+                auto v = thread->popOpr();
+
+                auto type = v.value[0].raw;
+                if (type == T_OBJECT) {
+                    Class *klass = v.value[1].object->klass;
+                    ip = tailCall(thread, ip, v.value[1], cache->dispatch(klass,
+                                                                          [klass, cache]() {
+                        return klass->protocolTable.dispatch(cache->pti, cache->vti);
+                    }));
+                    NEXT_INSTRUCTION();
+                }
+
+                auto typeId = normalizedBoxType(type);
+                auto function = protocolDispatchTableTable[typeId - protocolDTTOffset].dispatch(cache->pti, cache->vti);
+                if ((type & REMOTE_MASK) != 0) {
+                    ip = tailCall(thread, ip, v.value[1].object->val<Value>(), function);
+                }
+                else {
+                    ip = tailCall(thread, ip, v.value + 1, function);
+                }
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_TAIL_CALL_CONTEXTED_FUNCTION)
+                ip = tailCall(thread, ip + 1, thread->popOpr(), ip->function);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_TAIL_CALL_FUNCTION)
+                ip = tailCall(thread, ip + 1, Value(), ip->function);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_INTRINSIC_LIST_COUNT) {
+                Value v = thread->popOpr();
+                if (v.object->klass != CL_LIST) {
+                    ip = callIntrinsicMethod(thread, ip, v);
+                    NEXT_INSTRUCTION();
+                }
+                thread->pushOpr(static_cast<EmojicodeInteger>(v.object->val<List>()->count));
+                ip += 2;
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_INTRINSIC_LIST_GET) {
+                Value v = thread->popOpr();
+                if (v.object->klass != CL_LIST) {
+                    ip = callIntrinsicMethod(thread, ip, v);
+                    NEXT_INSTRUCTION();
+                }
+                auto *list = v.object->val<List>();
+                auto count = static_cast<EmojicodeInteger>(list->count);
+                EmojicodeInteger index = thread->popOpr().raw;
+                if (index < 0) {
+                    index += count;
+                }
+                if (index < 0 || count <= index) {
+                    thread->pushOpr(T_NOTHINGNESS);
+                    thread->pushPointerOpr(kBoxValueSize - 1);
+                }
+                else {
+                    thread->pushOpr(reinterpret_cast<Value *>(list->elements() + index), kBoxValueSize);
+                }
+                ip += 2;
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_INTRINSIC_LIST_SET) {
+                Value v = thread->popOpr();
+                if (v.object->klass == CL_LIST) {
+                    // Only replacing an existing element is done inline as growing the list might allocate.
+                    auto *list = v.object->val<List>();
+                    Value *arguments = thread->pointerOpr() - kBoxValueSize - 1;
+                    EmojicodeInteger index = arguments[0].raw;
+                    if (index >= 0 && index < static_cast<EmojicodeInteger>(list->count)) {
+                        list->elements()[index].copy(arguments + 1);
+                        recordWrite(v.object);
+                        thread->popOpr(kBoxValueSize + 1);
+                        ip += 2;
+                        NEXT_INSTRUCTION();
+                    }
+                }
+                ip = callIntrinsicMethod(thread, ip, v);
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_INTRINSIC_LIST_APPEND) {
+                Value v = thread->popOpr();
+                if (v.object->klass == CL_LIST) {
+                    // Only appending to a list with spare capacity is done inline as growing the list might allocate.
+                    auto *list = v.object->val<List>();
+                    if (list->count < list->capacity) {
+                        list->elements()[list->count++].copy(thread->popOpr(kBoxValueSize));
+                        recordWrite(v.object);
+                        ip += 2;
+                        NEXT_INSTRUCTION();
+                    }
+                }
+                ip = callIntrinsicMethod(thread, ip, v);
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_INTRINSIC_STRING_LENGTH) {
+                Value v = thread->popOpr();
+                if (v.object->klass != CL_STRING) {
+                    ip = callIntrinsicMethod(thread, ip, v);
+                    NEXT_INSTRUCTION();
+                }
+                thread->pushOpr(v.object->val<String>()->length);
+                ip += 2;
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_INTRINSIC_STRING_SYMBOL_AT) {
+                Value v = thread->popOpr();
+                if (v.object->klass != CL_STRING) {
+                    ip = callIntrinsicMethod(thread, ip, v);
+                    NEXT_INSTRUCTION();
+                }
+                auto *string = v.object->val<String>();
+                EmojicodeInteger index = thread->popOpr().raw;
+                if (index >= string->length) {
+                    thread->pushOpr(T_NOTHINGNESS);
+                    thread->pushPointerOpr(1);
+                }
+                else {
+                    thread->pushOpr(T_OPTIONAL_VALUE);
+                    thread->pushOpr(string->characters()[index]);
+                }
+                ip += 2;
+                NEXT_INSTRUCTION();
+            }
+            // Value types cannot be subclassed so that the intrinsics for their methods need no guard.
+            INSTRUCTION(INS_INTRINSIC_INTEGER_ABSOLUTE)
+                thread->pushOpr(std::abs(thread->popOpr().value->raw));
+                ip += 2;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_INTRINSIC_DOUBLE_SQRT)
+                thread->pushOpr(std::sqrt(thread->popOpr().value->doubl));
+                ip += 2;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_INTRINSIC_DOUBLE_FLOOR)
+                thread->pushOpr(static_cast<EmojicodeInteger>(std::floor(thread->popOpr().value->doubl)));
+                ip += 2;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_SIMPLE_OPTIONAL_PRODUCE) {
                 thread->pushOpr(static_cast<EmojicodeInteger>(T_OPTIONAL_VALUE));
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_PUSH_ERROR:
+            INSTRUCTION(INS_PUSH_ERROR)
                 thread->pushOpr(static_cast<EmojicodeInteger>(T_ERROR));
-                continue;
-            case INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE) {
                 auto *box = thread->popOpr(kBoxValueSize);
-                EmojicodeInstruction size = thread->consumeInstruction();
+                EmojicodeInstruction size = (ip++)->operand;
 
                 if (box[0].raw != T_NOTHINGNESS) {
                     thread->pushOpr(T_OPTIONAL_VALUE);
@@ -129,12 +544,12 @@ void execute(Thread *thread) {
                     thread->pushOpr(T_NOTHINGNESS);
                 }
                 thread->pushPointerOpr(size);  // The values of the box are still there, the type has been overwritten
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE_REMOTE: {
+            INSTRUCTION(INS_BOX_TO_SIMPLE_OPTIONAL_PRODUCE_REMOTE) {
                 auto *box = thread->popOpr(kBoxValueSize);
                 auto *value = box[1].object->val<Value>();
-                EmojicodeInstruction size = thread->consumeInstruction();
+                EmojicodeInstruction size = (ip++)->operand;
                 if (box[0].raw != T_NOTHINGNESS) {
                     thread->pushOpr(T_OPTIONAL_VALUE);  // We have just invalidated box!
                     thread->pushOpr(value, size);
@@ -143,11 +558,11 @@ void execute(Thread *thread) {
                     thread->pushOpr(T_NOTHINGNESS);
                     thread->pushPointerOpr(size);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_SIMPLE_OPTIONAL_TO_BOX: {
-                EmojicodeInstruction typeId = thread->consumeInstruction();
-                auto size = thread->consumeInstruction();
+            INSTRUCTION(INS_SIMPLE_OPTIONAL_TO_BOX) {
+                EmojicodeInstruction typeId = (ip++)->operand;
+                auto size = (ip++)->operand;
                 thread->popOpr(size);
                 if (thread->popOpr().raw != T_NOTHINGNESS) {
                     thread->pushOpr(static_cast<EmojicodeInteger>(typeId));
@@ -158,271 +573,298 @@ void execute(Thread *thread) {
                     thread->pushOpr(T_NOTHINGNESS);
                     thread->pushPointerOpr(kBoxValueSize - 1);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_SIMPLE_OPTIONAL_TO_BOX_REMOTE: {
-                EmojicodeInstruction typeId = thread->consumeInstruction();
-                auto size = thread->consumeInstruction();
-                auto *src = thread->popOpr(size + 1);
+            INSTRUCTION(INS_SIMPLE_OPTIONAL_TO_BOX_REMOTE) {
+                EmojicodeInstruction typeId = (ip++)->operand;
+                auto size = (ip++)->operand;
 
-                if (src->raw != T_NOTHINGNESS) {
+                if (thread->pointerOpr()[-static_cast<ptrdiff_t>(size + 1)].raw != T_NOTHINGNESS) {
+                    SAVE_IP();
                     auto *object = newArray(size * sizeof(Value));
+                    // The value is popped only now as the operand stack is updated by the garbage collector.
+                    auto *src = thread->popOpr(size + 1);
                     std::memcpy(object->val<Value>(), src + 1, size * sizeof(Value));
+                    object->klass = boxObjectVariableRecordTable[typeId & ~REMOTE_MASK].storageClass;
+                    recordWrite(object);
 
                     thread->pushOpr(static_cast<EmojicodeInteger>(typeId));
                     thread->pushOpr(object);
                     thread->pushPointerOpr(kBoxValueSize - 2);
                 }
                 else {
+                    thread->popOpr(size + 1);
                     thread->pushOpr(T_NOTHINGNESS);
                     thread->pushPointerOpr(kBoxValueSize - 1);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_PUSH_N:
-                thread->pushPointerOpr(thread->consumeInstruction());
-                continue;
-            case INS_POP:
+            INSTRUCTION(INS_PUSH_N)
+                thread->pushPointerOpr((ip++)->operand);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_POP)
                 thread->popOpr();
-                continue;
-            case INS_BOX_PRODUCE:
-                thread->pushOpr(static_cast<EmojicodeInteger>(thread->consumeInstruction()));
-                continue;
-            case INS_BOX_PRODUCE_REMOTE: {
-                auto size = thread->consumeInstruction();
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_BOX_PRODUCE)
+                thread->pushOpr(static_cast<EmojicodeInteger>((ip++)->operand));
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_BOX_PRODUCE_REMOTE) {
+                auto size = (ip++)->operand;
+                SAVE_IP();
                 auto object = newArray(size * sizeof(Value));
                 std::memcpy(object->val<Value>(), thread->popOpr(size), size * sizeof(Value));
-                thread->pushOpr(static_cast<EmojicodeInteger>(thread->consumeInstruction()));
+                auto type = (ip++)->operand;
+                object->klass = boxObjectVariableRecordTable[type & ~REMOTE_MASK].storageClass;
+                recordWrite(object);
+                thread->pushOpr(static_cast<EmojicodeInteger>(type));
                 thread->pushOpr(object);
                 thread->pushPointerOpr(kBoxValueSize - 2);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_UNBOX: {
-                EmojicodeInstruction size = thread->consumeInstruction();
+            INSTRUCTION(INS_UNBOX) {
+                EmojicodeInstruction size = (ip++)->operand;
                 thread->popThenPushOpr(kBoxValueSize, 1, size);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_UNBOX_REMOTE: {
+            INSTRUCTION(INS_UNBOX_REMOTE) {
                 auto *value = thread->popOpr(kBoxValueSize)[1].object->val<Value>();
-                EmojicodeInstruction size = thread->consumeInstruction();
+                EmojicodeInstruction size = (ip++)->operand;
                 thread->pushOpr(value, size);
-                continue;
-            }
-            case INS_PUSH_VT_REFERENCE_STACK:
-                thread->pushOpr(thread->variableDestination(thread->consumeInstruction()));
-                continue;
-            case INS_PUSH_VT_REFERENCE_OBJECT:
-                thread->pushOpr(thread->thisObject()->variableDestination(thread->consumeInstruction()));
-                continue;
-            case INS_PUSH_VT_REFERENCE_VT:
-                thread->pushOpr(thread->thisContext().value + thread->consumeInstruction());
-                continue;
-            case INS_PUSH_STACK_REFERENCE_N_BACK:
-                thread->pushOpr(thread->pointerOpr() - thread->consumeInstruction());
-                continue;
-            case INS_GET_CLASS_FROM_INSTANCE:
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_PUSH_VT_REFERENCE_STACK)
+                thread->pushOpr(thread->variableDestination((ip++)->operand));
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_PUSH_VT_REFERENCE_OBJECT)
+                thread->pushOpr(thread->thisObject()->variableDestination((ip++)->operand));
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_PUSH_VT_REFERENCE_VT)
+                thread->pushOpr(thread->thisContext().value + (ip++)->operand);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_PUSH_STACK_REFERENCE_N_BACK)
+                thread->pushOpr(thread->pointerOpr() - (ip++)->operand);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_CLASS_FROM_INSTANCE)
                 thread->pushOpr(thread->popOpr().object->klass);
-                continue;
-            case INS_GET_CLASS_FROM_INDEX:
-                thread->pushOpr(classTable[thread->consumeInstruction()]);
-                continue;
-            case INS_GET_STRING_POOL:
-                thread->pushOpr(stringPool[thread->consumeInstruction()]);
-                continue;
-            case INS_GET_TRUE:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_CLASS_FROM_INDEX)
+                thread->pushOpr((ip++)->klass);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_STRING_POOL)
+                thread->pushOpr(stringPool[(ip++)->operand]);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_TRUE)
                 thread->pushOpr(true);
-                continue;
-            case INS_GET_FALSE:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_FALSE)
                 thread->pushOpr(false);
-                continue;
-            case INS_GET_32_INTEGER:
-                thread->pushOpr(static_cast<EmojicodeInteger>(thread->consumeInstruction()) - INT32_MAX);
-                continue;
-            case INS_GET_64_INTEGER: {
-                EmojicodeInteger a = thread->consumeInstruction();
-                thread->pushOpr(a << 32 | thread->consumeInstruction());
-                continue;
-            }
-            case INS_GET_DOUBLE:
-                thread->pushOpr(readDouble(thread));
-                continue;
-            case INS_GET_SYMBOL:
-                thread->pushOpr(static_cast<EmojicodeChar>(thread->consumeInstruction()));
-                continue;
-            case INS_GET_NOTHINGNESS:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_32_INTEGER)
+                thread->pushOpr((ip++)->integer);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_64_INTEGER) {
+                thread->pushOpr(ip->integer);
+                ip += 2;
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_GET_DOUBLE)
+                thread->pushOpr(ip->doubl);
+                ip += 3;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_SYMBOL)
+                thread->pushOpr(static_cast<EmojicodeChar>((ip++)->operand));
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GET_NOTHINGNESS)
                 thread->pushOpr(T_NOTHINGNESS);
-                continue;
-            case INS_COPY_TO_STACK:
-                *thread->variableDestination(thread->consumeInstruction()) = thread->popOpr();
-                continue;
-            case INS_COPY_TO_INSTANCE_VARIABLE:
-                *thread->thisObject()->variableDestination(thread->consumeInstruction()) = thread->popOpr();
-                continue;
-            case INS_COPY_VT_VARIABLE:
-                *(thread->thisContext().value + thread->consumeInstruction()) = thread->popOpr();
-                continue;
-            case INS_COPY_TO_STACK_SIZE: {
-                auto n = thread->consumeInstruction();
-                std::memcpy(thread->variableDestination(thread->consumeInstruction()),
-                            thread->popOpr(n), n * sizeof(Value));
-                continue;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_COPY_TO_STACK)
+                *thread->variableDestination((ip++)->operand) = thread->popOpr();
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_COPY_TO_INSTANCE_VARIABLE)
+                *thread->thisObject()->variableDestination((ip++)->operand) = thread->popOpr();
+                recordWrite(thread->thisObject());
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_COPY_VT_VARIABLE) {
+                // The value might be stored in an object, in which case the object lies on the same card.
+                Value *destination = thread->thisContext().value + (ip++)->operand;
+                *destination = thread->popOpr();
+                recordWrite(destination);
+                NEXT_INSTRUCTION();
             }
-            case INS_COPY_TO_INSTANCE_VARIABLE_SIZE: {
-                auto n = thread->consumeInstruction();
-                std::memcpy(thread->thisObject()->variableDestination(thread->consumeInstruction()),
+            INSTRUCTION(INS_COPY_TO_STACK_SIZE) {
+                auto n = (ip++)->operand;
+                std::memcpy(thread->variableDestination((ip++)->operand),
                             thread->popOpr(n), n * sizeof(Value));
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_COPY_VT_VARIABLE_SIZE: {
-                auto n = thread->consumeInstruction();
-                std::memcpy(thread->thisContext().value + thread->consumeInstruction(),
+            INSTRUCTION(INS_COPY_TO_INSTANCE_VARIABLE_SIZE) {
+                auto n = (ip++)->operand;
+                std::memcpy(thread->thisObject()->variableDestination((ip++)->operand),
                             thread->popOpr(n), n * sizeof(Value));
-                continue;
-            }
-            case INS_PUSH_SINGLE_STACK:
-                thread->pushOpr(thread->variable(thread->consumeInstruction()));
-                continue;
-            case INS_PUSH_WITH_SIZE_STACK: {
-                auto *v = thread->variableDestination(thread->consumeInstruction());
-                thread->pushOpr(v, thread->consumeInstruction());
-                continue;
-            }
-            case INS_PUSH_SINGLE_OBJECT:
-                thread->pushOpr(*thread->thisObject()->variableDestination(thread->consumeInstruction()));
-                continue;
-            case INS_PUSH_WITH_SIZE_OBJECT: {
-                Value *source = thread->thisObject()->variableDestination(thread->consumeInstruction());
-                thread->pushOpr(source, thread->consumeInstruction());
-                continue;
-            }
-            case INS_PUSH_SINGLE_VT:
-                thread->pushOpr(thread->thisContext().value[thread->consumeInstruction()]);
-                continue;
-            case INS_PUSH_WITH_SIZE_VT: {
-                Value *source = thread->thisContext().value + thread->consumeInstruction();
-                thread->pushOpr(source, thread->consumeInstruction());
-                continue;
-            }
-            case INS_PUSH_VALUE_FROM_REFERENCE:
-                thread->pushOpr(thread->popOpr().value, thread->consumeInstruction());
-                continue;
+                recordWrite(thread->thisObject());
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_COPY_VT_VARIABLE_SIZE) {
+                auto n = (ip++)->operand;
+                Value *destination = thread->thisContext().value + (ip++)->operand;
+                std::memcpy(destination, thread->popOpr(n), n * sizeof(Value));
+                recordWrite(destination);
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_PUSH_SINGLE_STACK)
+                thread->pushOpr(thread->variable((ip++)->operand));
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_PUSH_WITH_SIZE_STACK) {
+                auto *v = thread->variableDestination((ip++)->operand);
+                thread->pushOpr(v, (ip++)->operand);
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_PUSH_SINGLE_OBJECT)
+                thread->pushOpr(*thread->thisObject()->variableDestination((ip++)->operand));
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_PUSH_WITH_SIZE_OBJECT) {
+                Value *source = thread->thisObject()->variableDestination((ip++)->operand);
+                thread->pushOpr(source, (ip++)->operand);
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_PUSH_SINGLE_VT)
+                thread->pushOpr(thread->thisContext().value[(ip++)->operand]);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_PUSH_WITH_SIZE_VT) {
+                Value *source = thread->thisContext().value + (ip++)->operand;
+                thread->pushOpr(source, (ip++)->operand);
+                NEXT_INSTRUCTION();
+            }
+            INSTRUCTION(INS_PUSH_VALUE_FROM_REFERENCE)
+                thread->pushOpr(thread->popOpr().value, (ip++)->operand);
+                NEXT_INSTRUCTION();
             // Operators
-            case INS_EQUAL_PRIMITIVE:
+            INSTRUCTION(INS_EQUAL_PRIMITIVE)
                 thread->pushOpr(thread->popOpr().raw == thread->popOpr().raw);
-                continue;
-            case INS_EQUAL_SYMBOL:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_EQUAL_SYMBOL)
                 thread->pushOpr(thread->popOpr().character == thread->popOpr().character);
-                continue;
-            case INS_SUBTRACT_INTEGER: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_SUBTRACT_INTEGER) {
                 auto b = thread->popOpr().raw;
                 thread->pushOpr(thread->popOpr().raw - b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_ADD_INTEGER:
+            INSTRUCTION(INS_ADD_INTEGER)
                 thread->pushOpr(thread->popOpr().raw + thread->popOpr().raw);
-                continue;
-            case INS_MULTIPLY_INTEGER:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_INCREMENT)
+                thread->variableDestination((ip++)->operand)->raw++;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_DECREMENT)
+                thread->variableDestination((ip++)->operand)->raw--;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_ADD_INTEGER_IMMEDIATE_TO_STACK)
+                thread->variableDestination(ip[0].operand)->raw += ip[1].integer;
+                ip += 2;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_MULTIPLY_INTEGER)
                 thread->pushOpr(thread->popOpr().raw * thread->popOpr().raw);
-                continue;
-            case INS_DIVIDE_INTEGER: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_DIVIDE_INTEGER) {
                 auto b = thread->popOpr().raw;
                 thread->pushOpr(thread->popOpr().raw / b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_REMAINDER_INTEGER: {
+            INSTRUCTION(INS_REMAINDER_INTEGER) {
                 auto b = thread->popOpr().raw;
                 thread->pushOpr(thread->popOpr().raw % b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_INVERT_BOOLEAN:
+            INSTRUCTION(INS_INVERT_BOOLEAN)
                 thread->pushOpr(!thread->popOpr().raw);
-                continue;
-            case INS_OR_BOOLEAN:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_OR_BOOLEAN)
                 thread->pushOpr(thread->popOpr().raw || thread->popOpr().raw);
-                continue;
-            case INS_AND_BOOLEAN:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_AND_BOOLEAN)
                 thread->pushOpr(thread->popOpr().raw && thread->popOpr().raw);
-                continue;
-            case INS_GREATER_INTEGER: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_GREATER_INTEGER) {
                 auto b = thread->popOpr().raw;
                 thread->pushOpr(thread->popOpr().raw > b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_GREATER_OR_EQUAL_INTEGER: {
+            INSTRUCTION(INS_GREATER_OR_EQUAL_INTEGER) {
                 auto b = thread->popOpr().raw;
                 thread->pushOpr(thread->popOpr().raw >= b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_SAME_OBJECT:
+            INSTRUCTION(INS_SAME_OBJECT)
                 thread->pushOpr(thread->popOpr().object == thread->popOpr().object);
-                continue;
-            case INS_IS_NOTHINGNESS:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_IS_NOTHINGNESS)
                 thread->pushOpr(thread->popOpr().value->raw == T_NOTHINGNESS);
-                continue;
-            case INS_IS_ERROR:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_IS_ERROR)
                 thread->pushOpr(thread->popOpr().value->raw == T_ERROR);
-                continue;
-            case INS_EQUAL_DOUBLE:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_EQUAL_DOUBLE)
                 thread->pushOpr(thread->popOpr().doubl == thread->popOpr().doubl);
-                continue;
-            case INS_SUBTRACT_DOUBLE: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_SUBTRACT_DOUBLE) {
                 auto b = thread->popOpr().doubl;
                 thread->pushOpr(thread->popOpr().doubl - b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_ADD_DOUBLE:
+            INSTRUCTION(INS_ADD_DOUBLE)
                 thread->pushOpr(thread->popOpr().doubl + thread->popOpr().doubl);
-                continue;
-            case INS_MULTIPLY_DOUBLE:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_MULTIPLY_DOUBLE)
                 thread->pushOpr(thread->popOpr().doubl * thread->popOpr().doubl);
-                continue;
-            case INS_DIVIDE_DOUBLE: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_DIVIDE_DOUBLE) {
                 auto b = thread->popOpr().doubl;
                 thread->pushOpr(thread->popOpr().doubl / b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_GREATER_DOUBLE: {
+            INSTRUCTION(INS_GREATER_DOUBLE) {
                 auto b = thread->popOpr().doubl;
                 thread->pushOpr(thread->popOpr().doubl > b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_GREATER_OR_EQUAL_DOUBLE: {
+            INSTRUCTION(INS_GREATER_OR_EQUAL_DOUBLE) {
                 auto b = thread->popOpr().doubl;
                 thread->pushOpr(thread->popOpr().doubl >= b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_REMAINDER_DOUBLE: {
+            INSTRUCTION(INS_REMAINDER_DOUBLE) {
                 auto b = thread->popOpr().doubl;
                 thread->pushOpr(fmod(thread->popOpr().doubl, b));
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_BINARY_AND_INTEGER:
+            INSTRUCTION(INS_BINARY_AND_INTEGER)
                 thread->pushOpr(thread->popOpr().raw & thread->popOpr().raw);
-                continue;
-            case INS_BINARY_OR_INTEGER:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_BINARY_OR_INTEGER)
                 thread->pushOpr(thread->popOpr().raw | thread->popOpr().raw);
-                continue;
-            case INS_BINARY_XOR_INTEGER:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_BINARY_XOR_INTEGER)
                 thread->pushOpr(thread->popOpr().raw ^ thread->popOpr().raw);
-                continue;
-            case INS_BINARY_NOT_INTEGER:
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_BINARY_NOT_INTEGER)
                 thread->pushOpr(~thread->popOpr().raw);
-                continue;
-            case INS_SHIFT_LEFT_INTEGER: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_SHIFT_LEFT_INTEGER) {
                 auto b = thread->popOpr().raw;
                 thread->pushOpr(thread->popOpr().raw << b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_SHIFT_RIGHT_INTEGER: {
+            INSTRUCTION(INS_SHIFT_RIGHT_INTEGER) {
                 auto b = thread->popOpr().raw;
                 thread->pushOpr(thread->popOpr().raw >> b);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_INT_TO_DOUBLE:
+            INSTRUCTION(INS_INT_TO_DOUBLE)
                 thread->pushOpr(static_cast<double>(thread->popOpr().raw));
-                continue;
-            case INS_UNWRAP_SIMPLE_OPTIONAL: {
-                EmojicodeInstruction n = thread->consumeInstruction();
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_UNWRAP_SIMPLE_OPTIONAL) {
+                EmojicodeInstruction n = (ip++)->operand;
                 auto *v = thread->popOpr().value;
                 if (v->raw != T_NOTHINGNESS) {
                     thread->pushOpr(v + 1, n);
@@ -430,9 +872,9 @@ void execute(Thread *thread) {
                 else {
                     error("Unexpectedly found ✨ while unwrapping a 🍬.");
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_UNWRAP_BOX_OPTIONAL: {
+            INSTRUCTION(INS_UNWRAP_BOX_OPTIONAL) {
                 auto *box = thread->popOpr().value;
                 if (box->raw != T_NOTHINGNESS) {
                     thread->pushOpr(box, kBoxValueSize);
@@ -440,10 +882,10 @@ void execute(Thread *thread) {
                 else {
                     error("Unexpectedly found ✨ while unwrapping a 🍬.");
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_ERROR_CHECK_SIMPLE_OPTIONAL: {
-                EmojicodeInteger n = thread->consumeInstruction();
+            INSTRUCTION(INS_ERROR_CHECK_SIMPLE_OPTIONAL) {
+                EmojicodeInteger n = (ip++)->operand;
                 auto *v = thread->popOpr().value;
                 if (v->raw != T_ERROR) {
                     thread->pushOpr(v + 1, n);
@@ -451,9 +893,9 @@ void execute(Thread *thread) {
                 else {
                     error("Unexpectedly found 🚨 with value %d.", v[1].raw);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_ERROR_CHECK_BOX_OPTIONAL: {
+            INSTRUCTION(INS_ERROR_CHECK_BOX_OPTIONAL) {
                 auto *box = thread->popOpr().value;
                 if (box->raw != T_ERROR) {
                     thread->pushOpr(box, kBoxValueSize);
@@ -461,21 +903,21 @@ void execute(Thread *thread) {
                 else {
                     error("Unexpectedly found 🚨 with value %d.", box[1].raw);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_THIS:
+            INSTRUCTION(INS_THIS)
                 thread->pushOpr(thread->thisContext());
-                continue;
-            case INS_SUPER_INITIALIZER: {
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_SUPER_INITIALIZER) {
                 Class *klass = thread->popOpr().klass;
 
-                EmojicodeInstruction vti = thread->consumeInstruction();
+                auto vti = (ip++)->operand;
                 Function *initializer = klass->initializersVtable[vti];
 
-                thread->pushStackFrame(thread->thisContext(), true, initializer);
-                continue;
+                ip = call(thread, ip, thread->thisContext(), initializer);
+                NEXT_INSTRUCTION();
             }
-            case INS_DOWNCAST_TO_CLASS: {
+            INSTRUCTION(INS_DOWNCAST_TO_CLASS) {
                 auto v = thread->popOpr();
                 Class *klass = thread->popOpr().klass;
                 if (v.object->klass->inheritsFrom(klass)) {
@@ -486,9 +928,9 @@ void execute(Thread *thread) {
                     thread->pushOpr(T_NOTHINGNESS);
                     thread->pushPointerOpr(1);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_CAST_TO_CLASS: {
+            INSTRUCTION(INS_CAST_TO_CLASS) {
                 auto *box = thread->popOpr(kBoxValueSize);
                 Class *klass = thread->popOpr().klass;
                 if (box[0].raw == T_OBJECT && box[1].object->klass->inheritsFrom(klass)) {
@@ -500,11 +942,11 @@ void execute(Thread *thread) {
                     thread->pushOpr(T_NOTHINGNESS);
                     thread->pushPointerOpr(1);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_CAST_TO_PROTOCOL: {
+            INSTRUCTION(INS_CAST_TO_PROTOCOL) {
                 auto *box = thread->popOpr(kBoxValueSize);
-                EmojicodeInstruction pi = thread->consumeInstruction();
+                EmojicodeInstruction pi = (ip++)->operand;
                 auto typeId = normalizedBoxType(box[0].raw) - protocolDTTOffset;
                 if (box[0].raw != T_NOTHINGNESS && ((box[0].raw == T_OBJECT &&
                                                      box[1].object->klass->protocolTable.conformsTo(pi)) ||
@@ -515,11 +957,11 @@ void execute(Thread *thread) {
                     thread->pushOpr(T_NOTHINGNESS);
                     thread->pushPointerOpr(kBoxValueSize - 1);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_CAST_TO_VALUE_TYPE: {
+            INSTRUCTION(INS_CAST_TO_VALUE_TYPE) {
                 auto *box = thread->popOpr(kBoxValueSize);
-                EmojicodeInstruction id = thread->consumeInstruction();
+                EmojicodeInstruction id = (ip++)->operand;
                 if (box[0].raw == id) {
                     thread->pushPointerOpr(kBoxValueSize);
                 }
@@ -527,148 +969,186 @@ void execute(Thread *thread) {
                     thread->pushOpr(T_NOTHINGNESS);
                     thread->pushPointerOpr(kBoxValueSize - 1);
                 }
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_RETURN:
+            INSTRUCTION(INS_RETURN)
                 if (thread->interrupt()) {
                     return;
                 }
                 thread->returnFromFunction();
-                continue;
-            case INS_JUMP_FORWARD:
-                thread->currentStackFrame()->executionPointer += thread->consumeInstruction();
-                continue;
-            case INS_JUMP_FORWARD_IF:
-                if (thread->popOpr().raw) {
-                    thread->currentStackFrame()->executionPointer += thread->consumeInstruction();
-                }
-                else {
-                    thread->consumeInstruction();
-                }
-                continue;
-            case INS_JUMP_BACKWARD_IF:
-                if (thread->popOpr().raw) {
-                    auto a = thread->consumeInstruction();
-                    thread->currentStackFrame()->executionPointer -= a;
-                }
-                else {
-                    thread->consumeInstruction();
-                }
-                continue;
-            case INS_JUMP_FORWARD_IF_NOT:
-                if (!thread->popOpr().raw) {
-                    thread->currentStackFrame()->executionPointer += thread->consumeInstruction();
-                }
-                else {
-                    thread->consumeInstruction();
-                }
-                continue;
-            case INS_JUMP_BACKWARD_IF_NOT:
-                if (!thread->popOpr().raw) {
-                    thread->currentStackFrame()->executionPointer -= thread->consumeInstruction();
-                }
-                else {
-                    thread->consumeInstruction();
-                }
-                continue;
-            case INS_TRANSFER_CONTROL_TO_NATIVE:
+                LOAD_IP();
+                ip = runCompiled(thread, ip);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_JUMP_FORWARD)
+                ip = ip->target;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_JUMP_FORWARD_IF)
+                ip = thread->popOpr().raw ? ip->target : ip + 1;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_JUMP_BACKWARD_IF)
+                ip = thread->popOpr().raw ? countAndRunCompiled(thread, ip->target) : ip + 1;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_JUMP_FORWARD_IF_NOT)
+                ip = !thread->popOpr().raw ? ip->target : ip + 1;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_JUMP_BACKWARD_IF_NOT)
+                ip = !thread->popOpr().raw ? countAndRunCompiled(thread, ip->target) : ip + 1;
+                NEXT_INSTRUCTION();
+#define STACK_IMMEDIATE_JUMP_HANDLERS(name, op) \
+            INSTRUCTION(INS_JUMP_BACKWARD_IF_STACK_##name##_IMMEDIATE) \
+                ip = thread->variable(ip[0].operand).raw op ip[1].integer ? \
+                    countAndRunCompiled(thread, ip[2].target) : ip + 3; \
+                NEXT_INSTRUCTION(); \
+            INSTRUCTION(INS_JUMP_FORWARD_IF_NOT_STACK_##name##_IMMEDIATE) \
+                ip = !(thread->variable(ip[0].operand).raw op ip[1].integer) ? ip[2].target : ip + 3; \
+                NEXT_INSTRUCTION();
+            STACK_IMMEDIATE_COMPARISONS(STACK_IMMEDIATE_JUMP_HANDLERS)
+#undef STACK_IMMEDIATE_JUMP_HANDLERS
+            INSTRUCTION(INS_TRANSFER_CONTROL_TO_NATIVE)
+                SAVE_IP();
                 thread->currentStackFrame()->function->handler(thread);
-                continue;
-            case INS_EXECUTE_CALLABLE: {
+                LOAD_IP();
+                ip = runCompiled(thread, ip);
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_EXECUTE_CALLABLE) {
                 auto *c = thread->popOpr().object->val<Closure>();
+                // Unlike call(), this never calls a leaf native without a frame as the captures need a frame to be
+                // loaded into. They are loaded before the safepoint in countAndRunCompiled() so that c is not moved
+                // before, and before compiled code of the function runs.
+                SAVE_IP();
                 thread->pushStackFrame(c->thisContext, true, c->function);
                 loadCapture(c, thread);
-                continue;
+                ip = countAndRunCompiled(thread, thread->currentStackFrame()->executionPointer);
+                NEXT_INSTRUCTION();
             }
-            case INS_CLOSURE: {
+            INSTRUCTION(INS_CLOSURE) {
+                SAVE_IP();
                 auto closure = thread->retain(newObject(CL_CLOSURE));
 
                 auto *c = closure->val<Closure>();
 
-                c->function = functionTable[thread->consumeInstruction()];
-                auto count = thread->consumeInstruction();
-                c->captureSize = thread->consumeInstruction();
-                c->captureDestination = thread->consumeInstruction();
+                c->function = (ip++)->function;
+                auto count = (ip++)->operand;
+                c->captureSize = (ip++)->operand;
+                c->captureDestination = (ip++)->operand;
 
+                SAVE_IP();
                 Object *captures = newArray(sizeof(Value) * c->captureSize);
                 c = closure->val<Closure>();
                 c->capturedVariables = captures;
 
                 auto *t = c->capturedVariables->val<Value>();
                 for (unsigned int i = 0; i < count; i++) {
-                    EmojicodeInstruction index = thread->consumeInstruction();
-                    EmojicodeInstruction size = thread->consumeInstruction();
+                    EmojicodeInstruction index = (ip++)->operand;
+                    EmojicodeInstruction size = (ip++)->operand;
                     std::memcpy(t, thread->variableDestination(index), size * sizeof(Value));
                     t += size;
                 }
 
-                auto recordCount = thread->consumeInstruction();
+                auto recordCount = (ip++)->operand;
                 c->recordsCount = recordCount;
+                SAVE_IP();
                 Object *objectVariableRecordsObject = newArray(sizeof(ObjectVariableRecord) * recordCount);
-                closure->val<Closure>()->objectVariableRecords = objectVariableRecordsObject;
+                c = closure->val<Closure>();
+                c->objectVariableRecords = objectVariableRecordsObject;
 
                 auto objectVariableRecords = objectVariableRecordsObject->val<ObjectVariableRecord>();
                 for (unsigned int i = 0; i < recordCount; i++) {
-                    auto value = thread->consumeInstruction();
+                    auto value = (ip++)->operand;
                     objectVariableRecords[i].variableIndex = static_cast<uint16_t>(value);
                     objectVariableRecords[i].condition = static_cast<uint16_t>(value >> 16);
-                    objectVariableRecords[i].type = static_cast<ObjectVariableType>(thread->consumeInstruction());
+                    objectVariableRecords[i].type = static_cast<ObjectVariableType>((ip++)->operand);
                 }
 
-                if (thread->consumeInstruction()) {
+                if ((ip++)->operand) {
                     c->thisContext = thread->thisContext();
                 }
+                // The closure was promoted if allocating the arrays caused a garbage collection.
+                recordWrite(closure.unretainedPointer());
 
                 thread->pushOpr(closure.unretainedPointer());
                 thread->release(1);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_CLOSURE_BOX: {
+            INSTRUCTION(INS_CLOSURE_BOX) {
+                SAVE_IP();
                 Object *closure = newObject(CL_CLOSURE);
 
                 auto *c = closure->val<Closure>();
 
-                c->function = functionTable[thread->consumeInstruction()];
+                c->function = (ip++)->function;
                 c->thisContext = thread->popOpr();
                 thread->pushOpr(closure);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_CAPTURE_METHOD: {
+            INSTRUCTION(INS_CAPTURE_METHOD) {
                 auto callee = thread->retain(thread->popOpr().object);
 
+                SAVE_IP();
                 Object *closureObject = newObject(CL_CLOSURE);
                 auto *closure = closureObject->val<Closure>();
 
-                EmojicodeInstruction vti = thread->consumeInstruction();
+                auto vti = (ip++)->operand;
                 closure->function = callee->klass->methodsVtable[vti];
                 closure->thisContext = callee.unretainedPointer();
                 thread->release(1);
                 thread->pushOpr(closureObject);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_CAPTURE_TYPE_METHOD: {
+            INSTRUCTION(INS_CAPTURE_TYPE_METHOD) {
+                SAVE_IP();
                 Object *closureObject = newObject(CL_CLOSURE);
                 auto *closure = closureObject->val<Closure>();
 
                 auto v = thread->popOpr();
-                EmojicodeInstruction vti = thread->consumeInstruction();
+                auto vti = (ip++)->operand;
                 closure->function = v.klass->methodsVtable[vti];
                 closure->thisContext = v;
                 thread->pushOpr(closureObject);
-                continue;
+                NEXT_INSTRUCTION();
             }
-            case INS_CAPTURE_CONTEXTED_FUNCTION: {
+            INSTRUCTION(INS_CAPTURE_CONTEXTED_FUNCTION) {
+                SAVE_IP();
                 Object *closureObject = newObject(CL_CLOSURE);
                 auto *closure = closureObject->val<Closure>();
 
-                EmojicodeInstruction vti = thread->consumeInstruction();
-                closure->function = functionTable[vti];
+                closure->function = (ip++)->function;
                 closure->thisContext = thread->popOpr();
 
                 thread->pushOpr(closureObject);
-                continue;
+                NEXT_INSTRUCTION();
             }
+            // Register instructions
+            INSTRUCTION(INS_REGISTER_MOVE_R)
+                *thread->variableDestination(ip[0].operand) = thread->variable(ip[1].operand);
+                ip += 3;
+                NEXT_INSTRUCTION();
+            INSTRUCTION(INS_REGISTER_MOVE_I)
+                *thread->variableDestination(ip[0].operand) = ip[1].integer;
+                ip += 3;
+                NEXT_INSTRUCTION();
+#define REGISTER_SOURCE_R(cell) thread->variable((cell).operand).raw
+#define REGISTER_SOURCE_I(cell) (cell).integer
+#define REGISTER_OPERATION_FORM(name, op, a, b) \
+            INSTRUCTION(INS_REGISTER_##name##_##a##b) \
+                *thread->variableDestination(ip[0].operand) = REGISTER_SOURCE_##a(ip[1]) op REGISTER_SOURCE_##b(ip[2]); \
+                ip += 6; \
+                NEXT_INSTRUCTION(); \
+            INSTRUCTION(INS_REGISTER_##name##_##a##b##_PUSH) \
+                thread->pushOpr(REGISTER_SOURCE_##a(ip[0]) op REGISTER_SOURCE_##b(ip[1])); \
+                ip += 4; \
+                NEXT_INSTRUCTION();
+#define REGISTER_OPERATION_HANDLERS(name, op) \
+            REGISTER_OPERATION_FORM(name, op, R, R) \
+            REGISTER_OPERATION_FORM(name, op, R, I) \
+            REGISTER_OPERATION_FORM(name, op, I, R)
+            REGISTER_OPERATIONS(REGISTER_OPERATION_HANDLERS)
+#undef REGISTER_OPERATION_HANDLERS
+#undef REGISTER_OPERATION_FORM
         }
+#ifdef threadedDispatch
+    L_ILLEGAL_INSTRUCTION:
+#endif
         error("Illegal bytecode instruction");
     }
 }
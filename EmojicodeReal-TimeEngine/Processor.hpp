@@ -10,11 +10,94 @@
 #define Processor_hpp
 
 #include "Engine.hpp"
+#include <atomic>
 
 namespace Emojicode {
 
+#if defined(__GNUC__) && !defined(DEBUG) && !defined(portableDispatch)
+/// Use labels as values to jump directly from the end of one instruction handler to the next one instead of going
+/// through the single indirect branch of the switch. Can be turned off with @c -DportableDispatch.
+#define threadedDispatch
+#endif
+
+/// The integer operations for which register instructions exist, together with the C++ operator implementing them.
+#define REGISTER_OPERATIONS(X) \
+    X(ADD, +) \
+    X(SUBTRACT, -) \
+    X(MULTIPLY, *) \
+    X(DIVIDE, /) \
+    X(REMAINDER, %) \
+    X(GREATER, >) \
+    X(GREATER_OR_EQUAL, >=) \
+    X(EQUAL, ==)
+
+/// Three-address instructions the decoder translates sequences of stack instructions into. See
+/// @c translateToRegisterInstructions(). They never appear in bytecode files.
+///
+/// The operands of a register operation are read from variable slots (R) or are integer immediates (I). The result is
+/// stored into a variable slot or, with the @c _PUSH variants, pushed onto the operand stack. A register instruction
+/// occupies the cells of the stack instructions it replaces and skips the remaining cells itself.
+enum RegisterInstructions {
+    /// Operands: destination, source variable
+    INS_REGISTER_MOVE_R = 0xC8,
+    /// Operands: destination, integer
+    INS_REGISTER_MOVE_I,
+#define REGISTER_OPERATION_INSTRUCTIONS(name, op) \
+    INS_REGISTER_##name##_RR, INS_REGISTER_##name##_RR_PUSH, \
+    INS_REGISTER_##name##_RI, INS_REGISTER_##name##_RI_PUSH, \
+    INS_REGISTER_##name##_IR, INS_REGISTER_##name##_IR_PUSH,
+    REGISTER_OPERATIONS(REGISTER_OPERATION_INSTRUCTIONS)
+#undef REGISTER_OPERATION_INSTRUCTIONS
+};
+
+/// The inline cache of a call site that dispatches a method or protocol method. It remembers the function for up to
+/// @c kSize receiver classes. Protocol methods of value types in a box are looked up in their protocol table directly.
+struct DispatchCache {
+    static constexpr size_t kSize = 4;
+
+    DispatchCache(EmojicodeInstruction vti, EmojicodeInstruction pti) : vti(vti), pti(pti) {}
+
+    /// Returns the function remembered for @c klass or calls @c lookup to find it and remembers it if there is space.
+    template <typename F>
+    Function* dispatch(const Class *klass, F lookup) {
+        for (auto &entry : entries_) {
+            if (entry.klass.load(std::memory_order_acquire) == klass) {
+                return entry.function;
+            }
+        }
+        Function *function = lookup();
+        if (count_.load(std::memory_order_relaxed) < kSize) {
+            // Every entry is written by only one thread as other threads might read it concurrently.
+            auto index = count_.fetch_add(1, std::memory_order_relaxed);
+            if (index < kSize) {
+                entries_[index].function = function;
+                entries_[index].klass.store(klass, std::memory_order_release);
+            }
+        }
+        return function;
+    }
+
+    const EmojicodeInstruction vti;
+    const EmojicodeInstruction pti;
+private:
+    struct Entry {
+        /// @c nullptr while the entry is unused, which never matches as every receiver has a class.
+        std::atomic<const Class *> klass{nullptr};
+        Function *function = nullptr;
+    };
+    Entry entries_[kSize];
+    std::atomic<size_t> count_{0};
+};
+
 void execute(Thread *thread);
 
+/// Returns the cell that makes the interpreter execute @c instruction.
+/// @attention @c prepareInterpreter() must have been called before.
+InstructionCell instructionCell(EmojicodeInstruction instruction);
+
+/// Prepares the interpreter. Must be called once before any bytecode is decoded.
+void prepareInterpreter();
+
 }
 
 #endif /* Processor_hpp */
@@ -8,13 +8,17 @@
 
 #include "Reader.hpp"
 #include "Class.hpp"
+#include "Decoder.hpp"
 #include "Engine.hpp"
 #include "String.hpp"
 #include "Memory.hpp"
+#include "utf8.h"
 #include "../EmojicodeInstructions.h"
 #include <cstdlib>
 #include <cstring>
 #include <dlfcn.h>
+#include <string>
+#include <vector>
 
 #ifdef DEBUG
 #define DEBUG_LOG(format, ...) printf(format "\n", ##__VA_ARGS__)
@@ -36,6 +40,19 @@ EmojicodeInstruction readInstruction(FILE *in) {
     return static_cast<EmojicodeInstruction>(fgetc(in)) | (fgetc(in) << 8) | (fgetc(in) << 16) | (fgetc(in) << 24);
 }
 
+/// Reads a name, which is stored as its number of characters followed by the characters, and returns it as UTF-8.
+const char* readName(FILE *in) {
+    std::string name;
+    for (uint16_t length = readUInt16(in); length > 0; length--) {
+        char character[5] = {};
+        u8_wc_toutf8(character, readEmojicodeChar(in));
+        name += character;
+    }
+    auto copy = new char[name.size() + 1];
+    std::memcpy(copy, name.c_str(), name.size() + 1);
+    return copy;
+}
+
 PackageLoadingState packageLoad(const char *name, uint16_t major, uint16_t minor,
                                 FunctionFunctionPointer **linkingTable, PrepareClassFunction *prepareClass) {
     char *path;
@@ -70,10 +87,15 @@ char* packageError() {
     return dlerror();
 }
 
+/// All functions read so far. They are decoded once the whole bytecode file was read, as instructions refer to
+/// functions and classes that might appear later in the file.
+std::vector<Function *> readFunctions;
+
 void readFunction(Function **table, FILE *in, FunctionFunctionPointer *linkingTable) {
     uint16_t vti = readUInt16(in);
 
-    auto *function = static_cast<Function *>(malloc(sizeof(Function)));
+    auto *function = static_cast<Function *>(calloc(1, sizeof(Function)));
+    function->name = readName(in);
     function->argumentCount = fgetc(in);
 
     DEBUG_LOG("*️⃣ Reading function with vti %d and takes %d argument(s)", vti, function->argumentCount);
@@ -97,6 +119,7 @@ void readFunction(Function **table, FILE *in, FunctionFunctionPointer *linkingTa
     if (native != 0) {
         DEBUG_LOG("Function has native function");
         function->handler = linkingTable[native];
+        function->leafHandler = sLeafFunction(function->handler);
     }
 
     function->block.instructionCount = readEmojicodeChar(in);
@@ -131,6 +154,7 @@ void readFunction(Function **table, FILE *in, FunctionFunctionPointer *linkingTa
               function->frameSize);
 
     table[vti] = function;
+    readFunctions.push_back(function);
 }
 
 void readProtocolAgreement(Function **vmt, Function ***pmt, uint_fast16_t offset, FILE *in) {
@@ -206,6 +230,7 @@ void readPackage(FILE *in) {
         EmojicodeChar name = readEmojicodeChar(in);
 
         auto *klass = new Class;
+        klass->name = name;
         classTable[classNextIndex++] = klass;
 
         DEBUG_LOG("Loading class %X into %p", name, klass);
@@ -327,6 +352,15 @@ Function* readBytecode(FILE *in) {
             boxObjectVariableRecordTable[i].records[j].condition = readUInt16(in);
             boxObjectVariableRecordTable[i].records[j].type = static_cast<ObjectVariableType>(readUInt16(in));
         }
+        if (boxObjectVariableRecordTable[i].count > 0) {
+            auto storageClass = new Class(nullptr);
+            storageClass->instanceVariableRecords = boxObjectVariableRecordTable[i].records;
+            storageClass->instanceVariableRecordsCount = boxObjectVariableRecordTable[i].count;
+            boxObjectVariableRecordTable[i].storageClass = storageClass;
+        }
+        else {
+            boxObjectVariableRecordTable[i].storageClass = CL_ARRAY;
+        }
     }
 
     stringPoolCount = readUInt16(in);
@@ -346,6 +380,11 @@ Function* readBytecode(FILE *in) {
         stringPool[i] = o;
     }
 
+    for (auto function : readFunctions) {
+        decodeFunction(function);
+    }
+    DEBUG_LOG("Decoded %zu function(s)", readFunctions.size());
+
     DEBUG_LOG("✅ Program ready for execution");
     return functionTable[0];
 }
@@ -10,12 +10,16 @@
 #define Reader_hpp
 
 #include "Engine.hpp"
+#include <vector>
 
 namespace Emojicode {
 
 /// Reads a bytecode file
 Function* readBytecode(FILE *in);
 
+/// All functions in the order in which they appear in the bytecode file
+extern std::vector<Function *> readFunctions;
+
 /** Determines whether the loading of a package was succesfull */
 enum PackageLoadingState {
     PACKAGE_LOADING_FAILED, PACKAGE_HEADER_NOT_FOUND, PACKAGE_INAPPROPRIATE_MAJOR, PACKAGE_INAPPROPRIATE_MINOR,
@@ -75,19 +75,22 @@ const char* stringToCString(Object *str) {
     return utf8str;
 }
 
-Object* stringFromChar(const char *cstring) {
+Object* stringFromChar(const char *cstring, Thread *thread) {
     EmojicodeInteger len = u8_strlen(cstring);
 
     if (len == 0) {
         return emptyString;
     }
 
+    auto co = thread->retain(newArray(len * sizeof(EmojicodeChar)));
+    u8_toucs(co->val<EmojicodeChar>(), len, cstring, strlen(cstring));
+
     Object *stro = newObject(CL_STRING);
     auto *string = stro->val<String>();
     string->length = len;
-    string->charactersObject = newArray(len * sizeof(EmojicodeChar));
-
-    u8_toucs(string->characters(), len, cstring, strlen(cstring));
+    string->charactersObject = co.unretainedPointer();
+    writeBarrier(stro);
+    thread->release(1);
 
     return stro;
 }
@@ -184,6 +187,7 @@ void stringGetInput(Thread *thread) {
     Object *chars = newArray(len * sizeof(EmojicodeChar));
     string = thread->thisObject()->val<String>();
     string->charactersObject = chars;
+    writeBarrier(thread->thisObject());
 
     u8_toucs(string->characters(), len, buffer->val<char>(), bufferUsedSize);
     thread->returnFromFunction(thread->thisContext());
@@ -212,7 +216,7 @@ void stringSplitByStringBridge(Thread *thread) {
                     stro = stringSubstring(firstAfterSeperator,
                                            i - firstAfterSeperator - separator->val<String>()->length + 1, thread);
                 }
-                listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT, stro);
+                listAppendObject(listObject, stro, thread);
                 seperatorIndex = 0;
                 firstAfterSeperator = i + 1;
             }
@@ -229,19 +233,22 @@ void stringSplitByStringBridge(Thread *thread) {
 
     Object *stringObject = thread->thisObject();
     auto *string = stringObject->val<String>();
-    listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT, stringSubstring(firstAfterSeperator, string->length - firstAfterSeperator, thread));
+    listAppendObject(listObject, stringSubstring(firstAfterSeperator, string->length - firstAfterSeperator, thread),
+                     thread);
 
     thread->release(1);
     thread->returnFromFunction(listObject.unretainedPointer());
 }
 
-void stringLengthBridge(Thread *thread) {
-    thread->returnFromFunction(thread->thisObject()->val<String>()->length);
+Value* stringLengthBridge(Value thisContext, Value *arguments) {
+    arguments[0] = thisContext.object->val<String>()->length;
+    return arguments + 1;
 }
 
-void stringUTF8LengthBridge(Thread *thread) {
-    auto *str = thread->thisObject()->val<String>();
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(u8_codingsize(str->characters(), str->length)));
+Value* stringUTF8LengthBridge(Value thisContext, Value *arguments) {
+    auto *str = thisContext.object->val<String>();
+    arguments[0] = static_cast<EmojicodeInteger>(u8_codingsize(str->characters(), str->length));
+    return arguments + 1;
 }
 
 void stringByAppendingSymbolBridge(Thread *thread) {
@@ -263,15 +270,17 @@ void stringByAppendingSymbolBridge(Thread *thread) {
     thread->returnFromFunction(ostro);
 }
 
-void stringSymbolAtBridge(Thread *thread) {
-    EmojicodeInteger index = thread->variable(0).raw;
-    auto *str = thread->thisObject()->val<String>();
+Value* stringSymbolAtBridge(Value thisContext, Value *arguments) {
+    EmojicodeInteger index = arguments[0].raw;
+    auto *str = thisContext.object->val<String>();
     if (index >= str->length) {
-        thread->returnNothingnessFromFunction();
-        return;
+        arguments[0] = T_NOTHINGNESS;
+        return arguments + 2;
     }
 
-    thread->returnOEValueFromFunction(str->characters()[index]);
+    arguments[0] = T_OPTIONAL_VALUE;
+    arguments[1] = str->characters()[index];
+    return arguments + 2;
 }
 
 void stringBeginsWithBridge(Thread *thread) {
@@ -306,14 +315,13 @@ void stringSplitBySymbolBridge(Thread *thread) {
 
     for (EmojicodeInteger i = 0, l = thread->thisObject()->val<String>()->length; i < l; i++) {
         if (thread->thisObject()->val<String>()->characters()[i] == separator) {
-            listAppendDestination(list, thread)->copySingleValue(T_OBJECT, stringSubstring(from, i - from, thread));
+            listAppendObject(list, stringSubstring(from, i - from, thread), thread);
             from = i + 1;
         }
     }
 
     Object *stringObject = thread->thisObject();
-    listAppendDestination(list, thread)->copySingleValue(T_OBJECT,
-                                    stringSubstring(from, stringObject->val<String>()->length - from, thread));
+    listAppendObject(list, stringSubstring(from, stringObject->val<String>()->length - from, thread), thread);
 
     thread->release(1);
     thread->returnFromFunction(list.unretainedPointer());
@@ -340,21 +348,26 @@ void stringToData(Thread *thread) {
 }
 
 void stringToCharacterList(Thread *thread) {
-    auto *str = thread->thisObject()->val<String>();
     auto list = thread->retain(newObject(CL_LIST));
 
-    for (size_t i = 0; i < str->length; i++) {
-        listAppendDestination(list, thread)->copySingleValue(T_SYMBOL, str->characters()[i]);
+    for (size_t i = 0; i < thread->thisObject()->val<String>()->length; i++) {
+        Box *destination = listAppendDestination(list, thread);
+        destination->copySingleValue(T_SYMBOL, thread->thisObject()->val<String>()->characters()[i]);
     }
 
+    thread->release(1);
     thread->returnFromFunction(list.unretainedPointer());
 }
 
-void initStringFromSymbolList(String *str, List *list) {
-    size_t count = list->count;
+void initStringFromSymbolList(RetainedObjectPointer stringObject, RetainedObjectPointer listObject) {
+    size_t count = listObject->val<List>()->count;
+    Object *characters = newArray(count * sizeof(EmojicodeChar));
+    auto *str = stringObject->val<String>();
     str->length = count;
-    str->charactersObject = newArray(count * sizeof(EmojicodeChar));
+    str->charactersObject = characters;
+    writeBarrier(stringObject.unretainedPointer());
 
+    auto *list = listObject->val<List>();
     for (size_t i = 0; i < count; i++) {
         Box b = list->elements()[i];
         if (b.isNothingness()) {
@@ -365,8 +378,7 @@ void initStringFromSymbolList(String *str, List *list) {
 }
 
 void stringFromSymbolListBridge(Thread *thread) {
-    auto *str = thread->thisObject()->val<String>();
-    initStringFromSymbolList(str, thread->variable(0).object->val<List>());
+    initStringFromSymbolList(thread->thisObjectAsRetained(), thread->variableObjectPointerAsRetained(0));
     thread->returnFromFunction(thread->thisContext());
 }
 
@@ -396,6 +408,7 @@ void stringFromStringList(Thread *thread) {
         auto *string = thread->thisObject()->val<String>();
         string->length = stringSize;
         string->charactersObject = co;
+        writeBarrier(thread->thisObject());
 
         for (size_t i = 0; i < list->count; i++) {
             auto *aString = list->elements()[i].value1.object->val<String>();
@@ -540,6 +553,7 @@ void stringToUppercase(Thread *thread) {
     auto *news = o->val<String>();
     news->charactersObject = characters;
     news->length = length;
+    writeBarrier(o.unretainedPointer());
     auto *os = thread->thisObject()->val<String>();
     for (size_t i = 0; i < length; i++) {
         EmojicodeChar c = os->characters()[i];
@@ -562,6 +576,7 @@ void stringToLowercase(Thread *thread) {
     auto *news = o->val<String>();
     news->charactersObject = characters;
     news->length = length;
+    writeBarrier(o.unretainedPointer());
     auto *os = thread->thisObject()->val<String>();
     for (size_t i = 0; i < length; i++) {
         EmojicodeChar c = os->characters()[i];
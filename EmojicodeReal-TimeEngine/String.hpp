@@ -10,6 +10,7 @@
 #define EmojicodeString_h
 
 #include "EmojicodeAPI.hpp"
+#include "RetainedObjectPointer.hpp"
 
 namespace Emojicode {
 
@@ -34,13 +35,13 @@ bool stringEqual(String *a, String *b);
 const char* stringToCString(Object *str);
 
 /** Creates a string from a UTF8 C string. The string must be null terminated! */
-Object* stringFromChar(const char *cstring);
+Object* stringFromChar(const char *cstring, Thread *thread);
 
 void stringMark(Object *self);
 
 struct List;
 
-void initStringFromSymbolList(String *string, List *list);
+void initStringFromSymbolList(RetainedObjectPointer stringObject, RetainedObjectPointer listObject);
 
 void stringPrintStdoutBrigde(Thread *thread);
 void stringEqualBridge(Thread *thread);
@@ -49,10 +50,10 @@ void stringIndexOf(Thread *thread);
 void stringTrimBridge(Thread *thread);
 void stringGetInput(Thread *thread);
 void stringSplitByStringBridge(Thread *thread);
-void stringLengthBridge(Thread *thread);
-void stringUTF8LengthBridge(Thread *thread);
+Value* stringLengthBridge(Value thisContext, Value *arguments);
+Value* stringUTF8LengthBridge(Value thisContext, Value *arguments);
 void stringByAppendingSymbolBridge(Thread *thread);
-void stringSymbolAtBridge(Thread *thread);
+Value* stringSymbolAtBridge(Value thisContext, Value *arguments);
 void stringBeginsWithBridge(Thread *thread);
 void stringEndsWithBridge(Thread *thread);
 void stringSplitBySymbolBridge(Thread *thread);
@@ -9,6 +9,7 @@
 #include "Thread.hpp"
 #include "Memory.hpp"
 #include "Processor.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <thread>
@@ -43,21 +44,28 @@ void Thread::debugOprStack() {
     puts("┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅┅");
 }
 
-StackFrame* Thread::pushStackFrame(Value self, bool copyArgs, Function *function) {
+/// Returns the number of bytes a stack frame for @c function occupies.
+static size_t stackFrameSize(Function *function) {
     size_t fullSize = sizeof(StackFrame) + sizeof(Value) * function->frameSize;
+    return fullSize + (fullSize % alignof(StackFrame));
+}
 
-    auto *sf = (StackFrame *)((Byte *)stack_ - (fullSize + (fullSize % alignof(StackFrame))));
+StackFrame* Thread::pushStackFrame(Value self, bool copyArgs, Function *function) {
+    auto *sf = (StackFrame *)((Byte *)stack_ - stackFrameSize(function));
     if (sf < stackLimit_) {
         error("Your program triggerd a stack overflow!");
     }
 
     sf->thisContext = self;
     sf->returnPointer = stack_;
-    sf->executionPointer = function->block.instructions;
+    sf->executionPointer = function->block.cells;
     sf->function = function;
+    // Variables are only marked once they were initialized but a variable might not have been initialized on every
+    // path that leads to an instruction.
+    std::fill_n(sf->variableDestination(0), function->frameSize, Value(static_cast<EmojicodeInteger>(0)));
 
     if (copyArgs) {
-        EmojicodeInstruction copySize = consumeInstruction();
+        size_t copySize = consumeInstruction().operand;
         std::memcpy(sf->variableDestination(0), popOpr(copySize), copySize * sizeof(Value));
     }
 #ifdef DEBUG
@@ -67,6 +75,23 @@ StackFrame* Thread::pushStackFrame(Value self, bool copyArgs, Function *function
     return stack_;
 }
 
+StackFrame* Thread::replaceStackFrame(Value self, Function *function) {
+    size_t copySize = consumeInstruction().operand;
+    // The return pointer is not used to find the end of the current frame as it is null if an interruption is
+    // configured, which the new frame must inherit.
+    StackFrame *returnPointer = stack_->returnPointer;
+    stack_ = (StackFrame *)((Byte *)stack_ + stackFrameSize(stack_->function));
+    pushStackFrame(self, false, function);
+    stack_->returnPointer = returnPointer;
+    std::memcpy(stack_->variableDestination(0), popOpr(copySize), copySize * sizeof(Value));
+    return stack_;
+}
+
+bool Thread::currentStackFrameContains(const void *pointer) const {
+    auto *bytes = static_cast<const Byte *>(pointer);
+    return (const Byte *)stack_ <= bytes && bytes < (const Byte *)stack_ + stackFrameSize(stack_->function);
+}
+
 void Thread::popStackFrame() {
 #ifdef DEBUG
     puts("=== POP FRAME ===");
@@ -75,8 +100,10 @@ void Thread::popStackFrame() {
 }
 
 void Thread::markStack() {
-    for (auto frame = stack_; frame < stackBottom_; frame = frame->returnPointer) {
-        unsigned int delta = frame->executionPointer ? frame->executionPointer - frame->function->block.instructions : 0;
+    // Frames are adjacent. The return pointer cannot be followed as it is null if an interruption is configured.
+    for (auto frame = stack_; frame < stackBottom_;
+         frame = reinterpret_cast<StackFrame *>(reinterpret_cast<Byte *>(frame) + stackFrameSize(frame->function))) {
+        unsigned int delta = frame->executionPointer ? frame->executionPointer - frame->function->block.cells : 0;
         switch (frame->function->context) {
             case ContextType::Object:
                 mark(&frame->thisContext.object);
@@ -19,7 +19,7 @@ namespace Emojicode {
 
 struct StackFrame {
     StackFrame *returnPointer;
-    EmojicodeInstruction *executionPointer;
+    InstructionCell *executionPointer;
     Function *function;
 
     Value thisContext;  // This must always be the very last field!
@@ -36,7 +36,8 @@ private:
 
 class Thread {
 public:
-    friend void gc(std::unique_lock<std::mutex> &, size_t);
+    friend void markThread(Thread *thread);
+    friend void pinOperandReferents();
     friend Thread* ThreadsManager::allocateThread();
     friend void ThreadsManager::deallocateThread(Thread *thread);
     friend Thread* ThreadsManager::nextThread(Thread *thread);
@@ -46,8 +47,21 @@ public:
     /// Pushes a new stack frame
     /// @returns A pointer to the memory reserved for the variables.
     StackFrame* pushStackFrame(Value self, bool copyArgs, Function *function);
+    /// Replaces the current stack frame with a new stack frame for @c function, which returns to where the current
+    /// function would have returned to. The arguments are always copied from the operand stack.
+    /// @returns A pointer to the new stack frame.
+    StackFrame* replaceStackFrame(Value self, Function *function);
+    /// Returns true if @c pointer points into the current stack frame.
+    bool currentStackFrameContains(const void *pointer) const;
 
     StackFrame* currentStackFrame() const { return stack_; }
+    /// Returns true if no stack frame was pushed yet or all were popped.
+    bool stackEmpty() const { return stack_ == stackBottom_; }
+    /// Returns the stack frame of the function that called the function of @c frame or @c nullptr if @c frame is the
+    /// first frame or an interruption is configured.
+    StackFrame* callerStackFrame(const StackFrame *frame) const {
+        return frame->returnPointer == stackBottom_ ? nullptr : frame->returnPointer;
+    }
 
     /// Returns the content of the variable slot at the specific index from the stack associated with this thread
     Value variable(int index) const { return *variableDestination(index); }
@@ -59,9 +73,9 @@ public:
     /** Returns the object on which the method was called. */
     Object* thisObject() const { return stack_->thisContext.object; }
 
-    /// Consumes the next instruction from the current stack frame’s execution pointer, i.e. returns the value to which
-    /// the pointer currently points and increments the pointer.
-    EmojicodeInstruction consumeInstruction() { return *(stack_->executionPointer++); }
+    /// Consumes the next instruction cell from the current stack frame’s execution pointer, i.e. returns the cell to
+    /// which the pointer currently points and increments the pointer.
+    InstructionCell consumeInstruction() { return *(stack_->executionPointer++); }
 
     bool interrupt() const { return stack_->returnPointer == nullptr; }
     Interruption configureInterruption() {
@@ -156,6 +170,8 @@ public:
         rstackPointer_ -= pop - push;
     }
     void pushPointerOpr(size_t n) { rstackPointer_ += n; }
+    /// Returns the address of the operand stack pointer. Used by machine code that manipulates the operand stack.
+    Value** operandStackPointer() { return &rstackPointer_; }
     Value popOpr() {
 #ifdef DEBUG
         if (rstackPointer_ - 1 < rstack_) throw "stack underflow";
@@ -198,6 +214,16 @@ private:
     Value *rstackPointer_ = &rstack_[0];
 };
 
+/// Calls the leaf function @c leaf from a stack frame. Natives with a leaf implementation appear in the linking table
+/// in the form of this bridge, which is used wherever a stack frame is required, e.g. if a closure calls the native.
+template <LeafFunctionPointer leaf>
+void leafFunctionBridge(Thread *thread) {
+    Value *arguments = *thread->operandStackPointer();
+    thread->pushOpr(thread->variableDestination(0), thread->currentStackFrame()->function->frameSize);
+    *thread->operandStackPointer() = leaf(thread->thisContext(), arguments);
+    thread->returnFromFunction();
+}
+
 }
 
 #endif /* Thread_hpp */
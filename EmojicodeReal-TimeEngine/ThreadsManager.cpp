@@ -15,6 +15,7 @@ using Emojicode::Thread;
 Thread *lastThread_ = nullptr;
 std::atomic_uint threads_(0);
 std::mutex Emojicode::ThreadsManager::threadListMutex;
+thread_local Thread *currentThread_ = nullptr;
 
 Thread* Emojicode::ThreadsManager::anyThread() {
     return lastThread_;
@@ -28,6 +29,14 @@ Thread* Emojicode::ThreadsManager::nextThread(Thread *thread) {
     return thread->threadBefore_;
 }
 
+void Emojicode::ThreadsManager::enterThread(Thread *thread) {
+    currentThread_ = thread;
+}
+
+Thread* Emojicode::ThreadsManager::currentThread() {
+    return currentThread_;
+}
+
 Thread* Emojicode::ThreadsManager::allocateThread() {
     std::lock_guard<std::mutex> threadListLock(threadListMutex);
     auto thread = new Thread;
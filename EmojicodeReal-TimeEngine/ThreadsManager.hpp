@@ -22,6 +22,12 @@ namespace ThreadsManager {
     void deallocateThread(Thread *thread);
     Thread* anyThread();
     Thread* nextThread(Thread *thread);
+    /// Makes @c thread the thread returned by @c currentThread() on the calling OS thread. Must be called by the OS
+    /// thread that runs @c thread before it executes any code.
+    void enterThread(Thread *thread);
+    /// Returns the thread that runs on the calling OS thread or @c nullptr if the OS thread does not run Emojicode code,
+    /// like the garbage collector’s threads.
+    Thread* currentThread();
     unsigned int threadsCount();
 }  // namespace ThreadsManager
 
@@ -27,6 +27,7 @@
 #include <thread>
 #include <mutex>
 #include <unistd.h>
+#include <utility>
 
 namespace Emojicode {
 
@@ -43,13 +44,13 @@ static void systemGetEnv(Thread *thread) {
         return;
     }
 
-    thread->returnOEValueFromFunction(stringFromChar(env));
+    thread->returnOEValueFromFunction(stringFromChar(env, thread));
 }
 
 static void systemCWD(Thread *thread) {
     char path[1050];
     getcwd(path, sizeof(path));
-    thread->returnFromFunction(stringFromChar(path));
+    thread->returnFromFunction(stringFromChar(path, thread));
 }
 
 static void systemTime(Thread *thread) {
@@ -64,15 +65,43 @@ static void systemArgs(Thread *thread) {
     Object *items = newArray(sizeof(Value) * cliArgumentCount);
 
     listObject->val<List>()->items = items;
+    writeBarrier(listObject.unretainedPointer());
 
     for (int i = 0; i < cliArgumentCount; i++) {
-        listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT, stringFromChar(cliArguments[i]));
+        listAppendObject(listObject, stringFromChar(cliArguments[i], thread), thread);
     }
 
     thread->release(1);
     thread->returnFromFunction(listObject.unretainedPointer());
 }
 
+static void systemGarbageCollectionStatistics(Thread *thread) {
+    auto statistics = garbageCollectionStatistics();
+    const std::pair<const char *, size_t> entries[] = {
+        {"collections", statistics.collections},
+        {"majorCollections", statistics.majorCollections},
+        {"incrementalCollections", statistics.incrementalCollections},
+        {"bytesCopied", statistics.bytesCopied},
+        {"bytesFreed", statistics.bytesFreed},
+        {"objectsDeinitialized", statistics.objectsDeinitialized},
+        {"pauseMicroseconds", statistics.pauseMicroseconds},
+        {"maxPauseMicroseconds", statistics.maxPauseMicroseconds},
+        {"timeToPauseMicroseconds", statistics.timeToPauseMicroseconds},
+        {"heapSize", statistics.heapBytes},
+        {"heapUsed", statistics.heapBytesUsed},
+    };
+
+    auto dictionaryObject = thread->retain(newObject(CL_DICTIONARY));
+    dictionaryInit(dictionaryObject->val<EmojicodeDictionary>());
+    for (auto &entry : entries) {
+        auto key = thread->retain(stringFromChar(entry.first, thread));
+        *dictionaryPutVal(dictionaryObject, key, thread) = Box(T_INTEGER, static_cast<EmojicodeInteger>(entry.second));
+        thread->release(1);
+    }
+    thread->release(1);
+    thread->returnFromFunction(dictionaryObject.unretainedPointer());
+}
+
 static void systemSystem(Thread *thread) {
     FILE *f = popen(stringToCString(thread->variable(0).object), "r");
 
@@ -105,6 +134,7 @@ static void systemSystem(Thread *thread) {
     Object *chars = newArray(len * sizeof(EmojicodeChar));
     string = so->val<String>();
     string->charactersObject = chars;
+    writeBarrier(so.unretainedPointer());
 
     u8_toucs(string->characters(), len, buffer->val<char>(), bufferUsedSize);
     thread->release(2);
@@ -122,14 +152,18 @@ static void threadJoin(Thread *thread) {
 }
 
 static void threadSleepMicroseconds(Thread *thread) {
-    std::this_thread::sleep_for(std::chrono::microseconds(thread->variable(0).raw));
+    auto duration = std::chrono::microseconds(thread->variable(0).raw);
+    allowGC();
+    std::this_thread::sleep_for(duration);
+    disallowGCAndPauseIfNeeded();
     thread->returnFromFunction();
 }
 
 void threadStart(Thread *thread, RetainedObjectPointer callable) {
+    ThreadsManager::enterThread(thread);
     thread->release(1);
     executeCallableExtern(callable.unretainedPointer(), nullptr, 0, thread);
-    ThreadsManager::deallocateThread(thread);
+    deallocateFinishedThread(thread);
 }
 
 static void initThread(Thread *thread) {
@@ -208,8 +242,9 @@ static void prngDoubleUniform(Thread *thread) {
     thread->returnFromFunction(dist(*thread->thisObject()->val<std::mt19937_64>()));
 }
 
-static void integerAbsolute(Thread *thread) {
-    thread->returnFromFunction(std::abs(thread->thisContext().value->raw));
+static Value* integerAbsolute(Value thisContext, Value *arguments) {
+    arguments[0] = std::abs(thisContext.value->raw);
+    return arguments + 1;
 }
 
 static void symbolToString(Thread *thread) {
@@ -223,8 +258,9 @@ static void symbolToString(Thread *thread) {
     thread->returnFromFunction(stringObject);
 }
 
-static void symbolToInteger(Thread *thread) {
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(thread->thisContext().value->character));
+static Value* symbolToInteger(Value thisContext, Value *arguments) {
+    arguments[0] = static_cast<EmojicodeInteger>(thisContext.value->character);
+    return arguments + 1;
 }
 
 static void doubleToString(Thread *thread) {
@@ -271,60 +307,74 @@ static void doubleToString(Thread *thread) {
     thread->returnFromFunction(stringObject);
 }
 
-static void doubleSin(Thread *thread) {
-    thread->returnFromFunction(sin(thread->thisContext().value->doubl));
+static Value* doubleSin(Value thisContext, Value *arguments) {
+    arguments[0] = sin(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleCos(Thread *thread) {
-    thread->returnFromFunction(cos(thread->thisContext().value->doubl));
+static Value* doubleCos(Value thisContext, Value *arguments) {
+    arguments[0] = cos(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleTan(Thread *thread) {
-    thread->returnFromFunction(tan(thread->thisContext().value->doubl));
+static Value* doubleTan(Value thisContext, Value *arguments) {
+    arguments[0] = tan(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleASin(Thread *thread) {
-    thread->returnFromFunction(asin(thread->thisContext().value->doubl));
+static Value* doubleASin(Value thisContext, Value *arguments) {
+    arguments[0] = asin(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleACos(Thread *thread) {
-    thread->returnFromFunction(acos(thread->thisContext().value->doubl));
+static Value* doubleACos(Value thisContext, Value *arguments) {
+    arguments[0] = acos(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleATan(Thread *thread) {
-    thread->returnFromFunction(atan(thread->thisContext().value->doubl));
+static Value* doubleATan(Value thisContext, Value *arguments) {
+    arguments[0] = atan(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doublePow(Thread *thread) {
-    thread->returnFromFunction(pow(thread->thisContext().value->doubl, thread->variable(0).doubl));
+static Value* doublePow(Value thisContext, Value *arguments) {
+    arguments[0] = pow(thisContext.value->doubl, arguments[0].doubl);
+    return arguments + 1;
 }
 
-static void doubleSqrt(Thread *thread) {
-    thread->returnFromFunction(sqrt(thread->thisContext().value->doubl));
+static Value* doubleSqrt(Value thisContext, Value *arguments) {
+    arguments[0] = sqrt(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleRound(Thread *thread) {
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(round(thread->thisContext().value->doubl)));
+static Value* doubleRound(Value thisContext, Value *arguments) {
+    arguments[0] = static_cast<EmojicodeInteger>(round(thisContext.value->doubl));
+    return arguments + 1;
 }
 
-static void doubleCeil(Thread *thread) {
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(ceil(thread->thisContext().value->doubl)));
+static Value* doubleCeil(Value thisContext, Value *arguments) {
+    arguments[0] = static_cast<EmojicodeInteger>(ceil(thisContext.value->doubl));
+    return arguments + 1;
 }
 
-static void doubleFloor(Thread *thread) {
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(floor(thread->thisContext().value->doubl)));
+static Value* doubleFloor(Value thisContext, Value *arguments) {
+    arguments[0] = static_cast<EmojicodeInteger>(floor(thisContext.value->doubl));
+    return arguments + 1;
 }
 
-static void doubleLog2(Thread *thread) {
-    thread->returnFromFunction(log2(thread->thisContext().value->doubl));
+static Value* doubleLog2(Value thisContext, Value *arguments) {
+    arguments[0] = log2(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleLn(Thread *thread) {
-    thread->returnFromFunction(log(thread->thisContext().value->doubl));
+static Value* doubleLn(Value thisContext, Value *arguments) {
+    arguments[0] = log(thisContext.value->doubl);
+    return arguments + 1;
 }
 
-static void doubleAbsolute(Thread *thread) {
-    thread->returnFromFunction(fabs(thread->thisContext().value->doubl));
+static Value* doubleAbsolute(Value thisContext, Value *arguments) {
+    arguments[0] = fabs(thisContext.value->doubl);
+    return arguments + 1;
 }
 
 // MARK: Callable
@@ -335,6 +385,7 @@ static void closureMark(Object *o) {
         mark(&c->thisContext.object);
     }
     mark(&c->capturedVariables);
+    mark(&c->objectVariableRecords);
 
     auto value = c->capturedVariables->val<Value>();
     auto records = c->objectVariableRecords->val<ObjectVariableRecord>();
@@ -347,8 +398,8 @@ FunctionFunctionPointer sLinkingTable[] = {
     nullptr,
     //📇
     dataEqual,
-    dataSize,  // 🐔
-    dataGetByte,  // 🐽
+    leafFunctionBridge<dataSize>,  // 🐔
+    leafFunctionBridge<dataGetByte>,  // 🐽
     dataToString,  // 🔡
     dataSlice,  // 🔪
     dataIndexOf,  // 🔍
@@ -366,25 +417,25 @@ FunctionFunctionPointer sLinkingTable[] = {
     //🚂
     integerToString,  // 🔡
     nullptr,  // 🎰
-    integerAbsolute,  // 🏧
-    doubleSin,  //📓
-    doubleCos,  //📕
-    doubleTan,  //📘
-    doubleASin,  //📔
-    doubleACos,  //📙
-    doubleATan,  //📗
-    doublePow,  //🏂
-    doubleSqrt,  //⛷
-    doubleCeil,  //🚴
-    doubleFloor,  //🚵
-    doubleRound,  //🏇
-    doubleLog2,  //🚣
-    doubleLn,  //🏄
+    leafFunctionBridge<integerAbsolute>,  // 🏧
+    leafFunctionBridge<doubleSin>,  //📓
+    leafFunctionBridge<doubleCos>,  //📕
+    leafFunctionBridge<doubleTan>,  //📘
+    leafFunctionBridge<doubleASin>,  //📔
+    leafFunctionBridge<doubleACos>,  //📙
+    leafFunctionBridge<doubleATan>,  //📗
+    leafFunctionBridge<doublePow>,  //🏂
+    leafFunctionBridge<doubleSqrt>,  //⛷
+    leafFunctionBridge<doubleCeil>,  //🚴
+    leafFunctionBridge<doubleFloor>,  //🚵
+    leafFunctionBridge<doubleRound>,  //🏇
+    leafFunctionBridge<doubleLog2>,  //🚣
+    leafFunctionBridge<doubleLn>,  //🏄
     doubleToString,  //🔡
-    doubleAbsolute,  //🏧
+    leafFunctionBridge<doubleAbsolute>,  //🏧
     //🔣
     symbolToString,  //🔡
-    symbolToInteger,  //🚂
+    leafFunctionBridge<symbolToInteger>,  //🚂
     //💻
     systemExit,  //🚪
     systemGetEnv,  //🌳
@@ -396,10 +447,10 @@ FunctionFunctionPointer sLinkingTable[] = {
     nullptr,
     nullptr,
     listAppendBridge,  // bear
-    listGetBridge,  //🐽
+    leafFunctionBridge<listGetBridge>,  //🐽
     listRemoveBridge,  // koala
     listInsertBridge,  // monkey
-    listCountBridge,  //🐔
+    leafFunctionBridge<listCountBridge>,  //🐔
     listPopBridge,  // panda
     listShuffleInPlaceBridge,  //🐹
     listFromListBridge,  //🐮
@@ -411,14 +462,14 @@ FunctionFunctionPointer sLinkingTable[] = {
     initListEmptyBridge,
     stringPrintStdoutBrigde,
     stringEqualBridge,  //🐔
-    stringLengthBridge,  //📝
+    leafFunctionBridge<stringLengthBridge>,  //📝
     stringByAppendingSymbolBridge,  //🐽
-    stringSymbolAtBridge,  //🔪
+    leafFunctionBridge<stringSymbolAtBridge>,  //🔪
     stringSubstringBridge,  //🔍
     stringIndexOf,  //🔧
     stringTrimBridge,  //🔫
     stringSplitByStringBridge,  //📐
-    stringUTF8LengthBridge,  //💣
+    leafFunctionBridge<stringUTF8LengthBridge>,  //💣
     stringSplitBySymbolBridge,  //🎼
     stringBeginsWithBridge,  //⛳️
     stringEndsWithBridge,  //🎶
@@ -443,13 +494,51 @@ FunctionFunctionPointer sLinkingTable[] = {
     bridgeDictionaryKeys,  //🐙
     bridgeDictionaryClear,  //🐗
     bridgeDictionaryContains,  //🐣
-    bridgeDictionarySize,  //🐔
+    leafFunctionBridge<bridgeDictionarySize>,  //🐔
     initPrngWithoutSeed,
     prngIntegerUniform,
     prngDoubleUniform,
     listAppendList,
+    systemGarbageCollectionStatistics,  //🗑
 };
 
+/// The natives in @c sLinkingTable that can be called without a stack frame
+static const std::pair<FunctionFunctionPointer, LeafFunctionPointer> sLeafFunctions[] = {
+    {leafFunctionBridge<dataSize>, dataSize},
+    {leafFunctionBridge<dataGetByte>, dataGetByte},
+    {leafFunctionBridge<integerAbsolute>, integerAbsolute},
+    {leafFunctionBridge<doubleSin>, doubleSin},
+    {leafFunctionBridge<doubleCos>, doubleCos},
+    {leafFunctionBridge<doubleTan>, doubleTan},
+    {leafFunctionBridge<doubleASin>, doubleASin},
+    {leafFunctionBridge<doubleACos>, doubleACos},
+    {leafFunctionBridge<doubleATan>, doubleATan},
+    {leafFunctionBridge<doublePow>, doublePow},
+    {leafFunctionBridge<doubleSqrt>, doubleSqrt},
+    {leafFunctionBridge<doubleCeil>, doubleCeil},
+    {leafFunctionBridge<doubleFloor>, doubleFloor},
+    {leafFunctionBridge<doubleRound>, doubleRound},
+    {leafFunctionBridge<doubleLog2>, doubleLog2},
+    {leafFunctionBridge<doubleLn>, doubleLn},
+    {leafFunctionBridge<doubleAbsolute>, doubleAbsolute},
+    {leafFunctionBridge<symbolToInteger>, symbolToInteger},
+    {leafFunctionBridge<listGetBridge>, listGetBridge},
+    {leafFunctionBridge<listCountBridge>, listCountBridge},
+    {leafFunctionBridge<stringLengthBridge>, stringLengthBridge},
+    {leafFunctionBridge<stringSymbolAtBridge>, stringSymbolAtBridge},
+    {leafFunctionBridge<stringUTF8LengthBridge>, stringUTF8LengthBridge},
+    {leafFunctionBridge<bridgeDictionarySize>, bridgeDictionarySize},
+};
+
+LeafFunctionPointer sLeafFunction(FunctionFunctionPointer handler) {
+    for (auto &leafFunction : sLeafFunctions) {
+        if (leafFunction.first == handler) {
+            return leafFunction.second;
+        }
+    }
+    return nullptr;
+}
+
 void sPrepareClass(Class *klass, EmojicodeChar name) {
     switch (name) {
         case 0x1F521:
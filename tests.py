@@ -4,10 +4,14 @@ import os
 import dist
 import sys
 import re
+import json
+import shutil
+import tempfile
 
 compilation_tests = [
     "hello",
     "intTest",
+    "registerOperations",
     "if",
     "vars",
     "namespace",
@@ -43,6 +47,7 @@ compilation_tests = [
     "protocolGenericLayerClass",
     "protocolGenericLayerValueType",
     "protocolMulti",
+    "protocolPolymorphic",
     "assignmentByCallProtocol",
     "commonType",
     "typeAlias",
@@ -58,6 +63,25 @@ compilation_tests = [
     "closureCaptureValueType",
     "captureMethod",
     "captureTypeMethod",
+    "leafNatives",
+    "intrinsics",
+    "tailCall",
+    "fusedInstructions",
+    "generationalGC",
+    "valueReferenceGC",
+    "operandStackGC",
+    "incrementalGC",
+    "parallelGC",
+    "pinnedIO",
+    "heapGrowth",
+    "heapLimit",
+    "lazyZeroing",
+    "gcStatistics",
+    "largeObjectSpace",
+    "safepoints",
+    "closureSafepoint",
+    "finalizers",
+    "listGrowth",
     "errorIsError",
     "errorPerfect",
     "errorAvocado",
@@ -76,13 +100,37 @@ library_tests = [
     "listTest", "enumerator", "rangeTest", "dictionaryTest",
     # "jsonTest", "fileTest"
 ]
+# Environment variables set for the programs of some tests
+test_environments = {
+    "incrementalGC": {"EMOJICODE_GC_PAUSE": "1", "EMOJICODE_HEAP_SIZE": "32M",
+                      "EMOJICODE_MAX_HEAP_SIZE": "32M"},
+    "parallelGC": {"EMOJICODE_GC_THREADS": "4", "EMOJICODE_HEAP_SIZE": "8M",
+                   "EMOJICODE_MAX_HEAP_SIZE": "8M"},
+    "pinnedIO": {"EMOJICODE_HEAP_SIZE": "4M", "EMOJICODE_MAX_HEAP_SIZE": "4M"},
+    "heapGrowth": {"EMOJICODE_HEAP_SIZE": "1024K",
+                   "EMOJICODE_MAX_HEAP_SIZE": "8M",
+                   "EMOJICODE_HEAP_GROWTH": "50"},
+    "heapLimit": {"EMOJICODE_HEAP_SIZE": "2G",
+                  "EMOJICODE_MAX_HEAP_SIZE": "1024m"},
+    "heapProfile": {"EMOJICODE_HEAP_SIZE": "4M",
+                    "EMOJICODE_MAX_HEAP_SIZE": "4M",
+                    "EMOJICODE_HEAP_PROFILE_COLLECTION": "1"},
+    "allocationProfile": {"EMOJICODE_ALLOCATION_SAMPLE_INTERVAL": "4K"},
+    "heapWalk": {"EMOJICODE_GC_THREADS": "4", "EMOJICODE_HEAP_SIZE": "4M",
+                 "EMOJICODE_MAX_HEAP_SIZE": "4M"},
+}
 reject_tests = glob.glob(os.path.join(dist.source, "tests", "reject",
                                       "*.emojic"))
 
 failed_tests = []
+# Run every program a second time with the JIT compiling every function
+jit = len(sys.argv) > 2 and sys.argv[2] == "jit"
+# Run every program a second time with code compiled by emojicodeaot
+aot = len(sys.argv) > 2 and sys.argv[2] == "aot"
 
 emojicode = os.path.abspath("emojicode")
 emojicodec = os.path.abspath("emojicodec")
+emojicodeaot = os.path.abspath("emojicodeaot")
 os.environ["EMOJICODE_PACKAGES_PATH"] = os.path.join(dist.path, "packages")
 
 
@@ -92,6 +140,33 @@ def fail_test(name):
     failed_tests.append(name)
 
 
+def run_program(binary_path, environment={}, inspect=None):
+    """Runs the program in every mode and returns the completed processes.
+    inspect is called after every run, before the next one starts."""
+    env = dict(os.environ, **environment)
+    runs = []
+
+    def run_once(env):
+        runs.append(run([emojicode, binary_path], stdout=PIPE, env=env))
+        if inspect is not None:
+            inspect(runs[-1])
+
+    run_once(env)
+    if jit:
+        run_once(dict(env, EMOJICODE_JIT="0"))
+    if aot:
+        run([emojicodeaot, binary_path], check=True)
+        run([os.environ.get("CXX", "c++"), "-std=c++14", "-O1", "-shared",
+             "-fPIC", "-I" + os.path.join(dist.source,
+                                          "EmojicodeReal-TimeEngine"),
+             binary_path + ".cpp", "-o", binary_path + ".so"] +
+            os.environ.get("CXXFLAGS", "").split(), check=True)
+        run_once(env)
+        os.remove(binary_path + ".cpp")
+        os.remove(binary_path + ".so")
+    return runs
+
+
 def test_paths(name, kind):
     return (os.path.join(dist.source, "tests", kind, name + ".emojic"),
             os.path.join(dist.source, "tests", kind, name + ".emojib"))
@@ -101,21 +176,121 @@ def library_test(name):
     source_path, binary_path = test_paths(name, 's')
 
     run([emojicodec, source_path], check=True)
-    completed = run([emojicode, binary_path], stdout=PIPE)
-    if completed.returncode != 0:
-        fail_test(name)
-        print(completed.stdout.decode('utf-8'))
+    for completed in run_program(binary_path):
+        if completed.returncode != 0:
+            fail_test(name)
+            print(completed.stdout.decode('utf-8'))
 
 
-def compilation_test(name):
+def compilation_test(name, environment={}, inspect=None):
     source_path, binary_path = test_paths(name, 'compilation')
     run([emojicodec, source_path], check=True)
-    completed = run([emojicode, binary_path], stdout=PIPE)
     exp_path = os.path.join(dist.source, "tests", "compilation", name + ".txt")
-    output = completed.stdout.decode('utf-8')
-    if output != open(exp_path, "r", encoding='utf-8').read():
-        print(output)
-        fail_test(name)
+    environment = dict(test_environments.get(name, {}), **environment)
+    for completed in run_program(binary_path, environment, inspect):
+        output = completed.stdout.decode('utf-8')
+        if output != open(exp_path, "r", encoding='utf-8').read():
+            print(output)
+            fail_test(name)
+
+
+def check_heap_snapshot(path, profile):
+    """Checks that the snapshot at path is well-formed and agrees with the
+    heap profile of the same collection."""
+    lines = open(path, encoding='utf-8').read().splitlines()
+    roots = lines[0].split(" ")
+    objects = [line.split(" ") for line in lines[1:]
+               if not line.startswith("references ")]
+    summary = [line.split(" ") for line in lines[1 + len(objects):]]
+    assert roots[0] == "roots" and len(roots) > 1
+    classes = {}
+    references = {}
+    for number, fields in enumerate(objects):
+        assert int(fields[0]) == number and len(fields) >= 3
+        counts = classes.setdefault(fields[1], [0, 0])
+        counts[0] += 1
+        counts[1] += int(fields[2])
+        for reference in fields[3:]:
+            pair = (fields[1], objects[int(reference)][1])
+            references[pair] = references.get(pair, 0) + 1
+    assert all(int(reference) < len(objects) for reference in roots[1:])
+    assert all(fields[0] == "references" for fields in summary)
+    assert {(f[1], f[2]): int(f[3]) for f in summary} == references
+    assert {c["class"]: [c["instances"], c["bytes"]]
+            for c in profile["classes"]} == classes
+
+
+def read_heap_profiles(directory):
+    """Returns the heap profiles in directory after checking them and the
+    snapshots written along with them."""
+    profiles = [json.loads(line) for line in
+                open(os.path.join(directory, "heap"), encoding='utf-8')]
+    for profile in profiles:
+        sizes = [c["bytes"] for c in profile["classes"]]
+        assert sizes == sorted(sizes, reverse=True)
+        assert sum(sizes) <= profile["heapBytesUsed"]
+        assert all(c["class"] != "" for c in profile["classes"])
+        check_heap_snapshot(os.path.join(directory, "snapshot.{0}".format(
+            profile["collection"])), profile)
+    return profiles
+
+
+def instances(profile, name):
+    return sum(c["instances"] for c in profile["classes"]
+               if c["class"] == name)
+
+
+def check_heap_profile(directory):
+    profiles = read_heap_profiles(directory)
+    # The collection chosen in the environment and the one requested by the
+    # program with SIGUSR2
+    assert len(profiles) == 2 and profiles[0]["collection"] == 1
+    assert profiles[0]["collection"] < profiles[1]["collection"]
+    assert instances(profiles[1], "🐟") == 2000
+
+
+def check_heap_walk(directory):
+    # Walking the heap must step over the rests of the allocation and
+    # promotion buffers and find every fish the threads kept.
+    profiles = read_heap_profiles(directory)
+    assert len(profiles) == 1 and instances(profiles[0], "🐟") == 4000
+
+
+def check_allocation_profile(directory):
+    lines = open(os.path.join(directory, "allocations"),
+                 encoding='utf-8').read().splitlines()
+    assert lines[0] == "# bytes objects samples function offset class"
+    sites = [re.fullmatch(r"(\d+) (\d+) (\d+) (🏁|🍇|[^ .]+\.[^ .]+) (\d+) "
+                          r"(\S+)", line).groups() for line in lines[1:]]
+    sizes = [int(site[0]) for site in sites]
+    assert sizes == sorted(sizes, reverse=True)
+    # 🐟.🐇🐬 allocates 100000 fish
+    fishes = [site for site in sites
+              if site[3] == "🐟.🐇🐬" and site[5] == "🐟"]
+    assert len(fishes) == 1 and 90000 < int(fishes[0][1]) < 110000
+    assert any(site[3] == "🐟.🆕🆒" for site in sites)
+
+
+def profile_test(name, check):
+    """Runs the compilation test name with the profilers writing to a
+    temporary directory, which is passed to check after every run."""
+    directory = tempfile.mkdtemp()
+
+    def inspect(completed):
+        try:
+            check(directory)
+        except (AssertionError, AttributeError, IndexError, KeyError, OSError,
+                ValueError):
+            fail_test(name)
+        for path in os.listdir(directory):
+            os.remove(os.path.join(directory, path))
+
+    compilation_test(name, {
+        "EMOJICODE_HEAP_PROFILE": os.path.join(directory, "heap"),
+        "EMOJICODE_HEAP_SNAPSHOT": os.path.join(directory, "snapshot"),
+        "EMOJICODE_ALLOCATION_PROFILE": os.path.join(directory, "allocations"),
+    }, inspect)
+    shutil.rmtree(directory)
 
 
 def reject_test(filename):
@@ -140,6 +315,12 @@ for test in compilation_tests:
     compilation_test(test)
 for test in compilation_tests:
     prettyprint_test(test)
+# Compilation tests whose profiles are checked by the given function
+profile_tests = {"heapProfile": check_heap_profile,
+                 "allocationProfile": check_allocation_profile,
+                 "heapWalk": check_heap_walk}
+for test, check in profile_tests.items():
+    profile_test(test, check)
 
 included = os.path.join(dist.source, "tests", "compilation", "included.emojic")
 os.rename(included + '_original', included)